@@ -0,0 +1,62 @@
+// Throughput of the Base64 kernels against QByteArray::toBase64 on
+// screenshot-sized payloads.
+
+#include "Base64.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <cstdio>
+#include <functional>
+#include <initializer_list>
+#include <string>
+
+static double bestOfMs(int runs, const std::function<void()> &fn) {
+    double best = 1e300;
+    for (int r = 0; r < runs; ++r) {
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        best = qMin(best, timer.nsecsElapsed() / 1e6);
+    }
+    return best;
+}
+
+int main() {
+    std::printf("active kernel: %s\n", Base64::kernelName(Base64::activeKernel()));
+    std::printf("%-10s %-12s %10s %10s\n", "size", "impl", "ms", "MB/s");
+
+    for (qsizetype size : {qsizetype(64) * 1024, qsizetype(1) << 20, qsizetype(8) << 20}) {
+        QByteArray input(size, Qt::Uninitialized);
+        QRandomGenerator rng(42);
+        rng.fillRange(reinterpret_cast<quint32 *>(input.data()), size / 4);
+
+        const QByteArray reference = input.toBase64();
+        const double mb = size / (1024.0 * 1024.0);
+        const QString label = QString("%1 KiB").arg(size / 1024);
+
+        double qtMs = bestOfMs(20, [&] {
+            QByteArray out = input.toBase64();
+            Q_UNUSED(out)
+        });
+        std::printf("%-10s %-12s %10.3f %10.0f\n", qPrintable(label), "qt", qtMs, mb / (qtMs / 1000));
+
+        std::string out(Base64::encodedSize(size_t(size)), '\0');
+        for (auto kernel : {Base64::Kernel::Scalar, Base64::Kernel::Ssse3,
+                            Base64::Kernel::Avx2, Base64::Kernel::Avx512Vbmi}) {
+            if (!Base64::isSupported(kernel))
+                continue;
+
+            double ms = bestOfMs(20, [&] {
+                Base64::encodeWith(kernel, reinterpret_cast<const unsigned char *>(input.constData()),
+                                   size_t(size), &out[0]);
+            });
+            bool matches = out == reference.toStdString();
+            std::printf("%-10s %-12s %10.3f %10.0f%s\n", qPrintable(label), Base64::kernelName(kernel),
+                        ms, mb / (ms / 1000), matches ? "" : "  MISMATCH");
+            if (!matches)
+                return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "BenchHarness.h"
+
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+BenchHarness::BenchHarness(Options options) : m_options(std::move(options)) {}
+
+bool BenchHarness::wants(const std::string &name) const {
+    return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+}
+
+BenchHarness::Result *BenchHarness::run(const std::string &name, const std::function<void()> &fn,
+                                        double bytes) {
+    if (!wants(name))
+        return nullptr;
+
+    fn();
+
+    std::vector<double> samples;
+    QElapsedTimer total;
+    total.start();
+    while (int(samples.size()) < MAX_ITERATIONS
+           && (int(samples.size()) < MIN_ITERATIONS
+               || total.nsecsElapsed() / 1e6 < m_options.minTimeMs)) {
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        samples.push_back(timer.nsecsElapsed() / 1e6);
+    }
+
+    std::sort(samples.begin(), samples.end());
+    Result result;
+    result.name = name;
+    result.iterations = int(samples.size());
+    result.minMs = samples.front();
+    result.maxMs = samples.back();
+    const size_t mid = samples.size() / 2;
+    result.medianMs = samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2;
+    double sum = 0;
+    for (double sample : samples)
+        sum += sample;
+    result.meanMs = sum / samples.size();
+    result.bytes = bytes;
+
+    print(result);
+    m_results.push_back(std::move(result));
+    return &m_results.back();
+}
+
+void BenchHarness::fail(const std::string &name, const std::string &message) {
+    std::fprintf(stderr, "FAILED %s: %s\n", name.c_str(), message.c_str());
+    m_failures.push_back(name);
+}
+
+void BenchHarness::print(const Result &result) const {
+    FILE *out = m_options.jsonPath == "-" ? stderr : stdout;
+    if (m_results.empty())
+        std::fprintf(out, "%-44s %8s %10s %10s %10s\n", "case", "runs", "median ms", "min ms", "MB/s");
+    std::fprintf(out, "%-44s %8d %10.3f %10.3f", result.name.c_str(), result.iterations,
+                 result.medianMs, result.minMs);
+    if (result.bytes > 0)
+        std::fprintf(out, " %10.0f", result.bytes / (1024.0 * 1024.0) / (result.medianMs / 1000));
+    std::fprintf(out, "\n");
+}
+
+bool BenchHarness::compareWithBaseline() {
+    std::ifstream in(m_options.baselinePath);
+    json baseline = json::parse(in, nullptr, false);
+    if (baseline.is_discarded() || !baseline.contains("results")) {
+        std::fprintf(stderr, "Cannot read baseline %s\n", m_options.baselinePath.c_str());
+        return false;
+    }
+
+    std::map<std::string, double> before;
+    for (const json &entry : baseline["results"])
+        before[entry.value("name", "")] = entry.value("median_ms", 0.0);
+
+    bool ok = true;
+    for (const Result &result : m_results) {
+        auto it = before.find(result.name);
+        if (it == before.end() || it->second <= 0)
+            continue;
+        const double change = result.medianMs / it->second - 1;
+        if (change > m_options.tolerance) {
+            std::fprintf(stderr, "REGRESSION %s: %.3f ms, baseline %.3f ms (%+.0f%%)\n",
+                         result.name.c_str(), result.medianMs, it->second, change * 100);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int BenchHarness::finish() {
+    if (!m_options.jsonPath.empty()) {
+        json results = json::array();
+        for (const Result &result : m_results) {
+            json entry = {
+                {"name", result.name},
+                {"iterations", result.iterations},
+                {"min_ms", result.minMs},
+                {"median_ms", result.medianMs},
+                {"mean_ms", result.meanMs},
+                {"max_ms", result.maxMs}
+            };
+            if (result.bytes > 0) {
+                entry["bytes"] = result.bytes;
+                entry["mb_per_s"] = result.bytes / (1024.0 * 1024.0) / (result.medianMs / 1000);
+            }
+            for (const auto &[key, value] : result.counters)
+                entry["counters"][key] = value;
+            results.push_back(std::move(entry));
+        }
+        const std::string text = json{{"results", results}, {"failures", m_failures}}.dump(2) + "\n";
+
+        if (m_options.jsonPath == "-") {
+            std::fwrite(text.data(), 1, text.size(), stdout);
+        } else {
+            std::ofstream out(m_options.jsonPath, std::ios::binary);
+            out << text;
+            if (!out) {
+                std::fprintf(stderr, "Cannot write %s\n", m_options.jsonPath.c_str());
+                return 1;
+            }
+        }
+    }
+
+    bool ok = m_failures.empty();
+    if (!m_options.baselinePath.empty())
+        ok = compareWithBaseline() && ok;
+    return ok ? 0 : 1;
+}
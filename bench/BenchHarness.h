@@ -0,0 +1,59 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Small harness behind transIt_bench. Each case runs once to warm up, then
+// repeatedly until its time budget is spent; the table goes to stdout and
+// every result can be written as JSON. Given the JSON of an earlier run as
+// a baseline, cases whose median slowed down beyond the tolerance fail the
+// run, so a script can gate on the exit code.
+class BenchHarness {
+public:
+    struct Options {
+        std::string filter;        // substring of the case names to run
+        std::string jsonPath;      // "-" for stdout, which moves the table to stderr
+        std::string baselinePath;
+        double tolerance = 0.15;   // allowed median slowdown against the baseline
+        double minTimeMs = 200;    // per case, after the warm-up run
+    };
+
+    struct Result {
+        std::string name;
+        int iterations = 0;
+        double minMs = 0;
+        double medianMs = 0;
+        double meanMs = 0;
+        double maxMs = 0;
+        double bytes = 0;                        // input per iteration, for MB/s
+        std::map<std::string, double> counters;  // e.g. output size, block count
+    };
+
+    explicit BenchHarness(Options options);
+
+    // False for cases the filter excludes, so their setup can be skipped
+    bool wants(const std::string &name) const;
+
+    // Returns nullptr if the case was filtered out; otherwise its result,
+    // on which the caller may set counters until the next run()
+    Result *run(const std::string &name, const std::function<void()> &fn, double bytes = 0);
+
+    // A case whose output was wrong; fails the run
+    void fail(const std::string &name, const std::string &message);
+
+    // Writes the JSON, compares against the baseline and returns the exit code
+    int finish();
+
+private:
+    static constexpr int MIN_ITERATIONS = 5;
+    static constexpr int MAX_ITERATIONS = 100000;
+
+    void print(const Result &result) const;
+    bool compareWithBaseline();
+
+    Options m_options;
+    std::vector<Result> m_results;
+    std::vector<std::string> m_failures;
+};
@@ -0,0 +1,308 @@
+#include "MockProvider.h"
+
+#include <QRegularExpression>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <algorithm>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Unpaced streams still arrive in small deltas, as they do from providers
+static constexpr size_t UNPACED_PIECE = 16;
+
+static bool isContinuationByte(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+// Pieces of about pieceSize bytes that never split a UTF-8 sequence
+static std::vector<std::string> splitText(const std::string &text, size_t pieceSize) {
+    std::vector<std::string> pieces;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = std::min(text.size(), start + pieceSize);
+        while (end < text.size() && isContinuationByte(text[end]))
+            ++end;
+        pieces.push_back(text.substr(start, end - start));
+        start = end;
+    }
+    return pieces;
+}
+
+static json openAIChunk(const std::string &piece, const char *finishReason) {
+    json delta = json::object();
+    if (!piece.empty())
+        delta["content"] = piece;
+    return {{"id", "chatcmpl-mock"},
+            {"object", "chat.completion.chunk"},
+            {"choices", {{{"index", 0},
+                          {"delta", delta},
+                          {"finish_reason", finishReason ? json(finishReason) : json(nullptr)}}}}};
+}
+
+static json geminiCandidate(const std::string &text, const char *finishReason) {
+    json candidate = {{"content", {{"parts", {{{"text", text}}}}, {"role", "model"}}},
+                      {"index", 0}};
+    if (finishReason)
+        candidate["finishReason"] = finishReason;
+    return {{"candidates", {candidate}}, {"modelVersion", "mock"}};
+}
+
+static const char *statusText(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 404: return "Not Found";
+    default: return "Internal Server Error";
+    }
+}
+
+MockProvider::MockProvider(const Options &options, QObject *parent)
+    : QObject(parent), m_server(new QTcpServer(this)), m_options(options), m_random(options.seed)
+{
+    connect(m_server, &QTcpServer::newConnection, this, &MockProvider::onNewConnection);
+}
+
+bool MockProvider::listen(quint16 port) {
+    return m_server->listen(QHostAddress::LocalHost, port);
+}
+
+quint16 MockProvider::port() const {
+    return m_server->serverPort();
+}
+
+QString MockProvider::baseUrl() const {
+    return QString("http://127.0.0.1:%1").arg(port());
+}
+
+void MockProvider::setOptions(const Options &options) {
+    m_options = options;
+    m_random.seed(options.seed);
+}
+
+void MockProvider::setReplies(std::vector<std::string> replies) {
+    m_replies = std::move(replies);
+    m_nextReply = 0;
+}
+
+void MockProvider::onNewConnection() {
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readRequests(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_buffers.remove(socket);
+            m_busy.remove(socket);
+            m_continued.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockProvider::readRequests(QTcpSocket *socket) {
+    QByteArray &buffer = m_buffers[socket];
+    buffer += socket->readAll();
+    // No pipelining: the next request is looked at once this response is out
+    if (m_busy.contains(socket))
+        return;
+
+    const qsizetype headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (size_t(buffer.size()) > MAX_HEADER_BYTES)
+            socket->abort();
+        return;
+    }
+
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    Request request;
+    request.path = requestLine.value(1);
+    qsizetype contentLength = 0;
+    bool expectContinue = false;
+    for (qsizetype i = 1; i < lines.size(); ++i) {
+        const qsizetype colon = lines[i].indexOf(':');
+        if (colon < 0)
+            continue;
+        const QByteArray name = lines[i].left(colon).trimmed().toLower();
+        const QByteArray value = lines[i].mid(colon + 1).trimmed().toLower();
+        if (name == "content-length")
+            contentLength = value.toLongLong();
+        else if (name == "connection")
+            request.keepAlive = value != "close";
+        else if (name == "expect")
+            expectContinue = value == "100-continue";
+    }
+
+    // curl holds back large bodies until it is told to go ahead
+    const qsizetype bodyStart = headerEnd + 4;
+    if (buffer.size() - bodyStart < contentLength) {
+        if (expectContinue && !m_continued.contains(socket)) {
+            m_continued.insert(socket);
+            socket->write("HTTP/1.1 100 Continue\r\n\r\n");
+        }
+        return;
+    }
+    m_continued.remove(socket);
+    request.body = buffer.mid(bodyStart, contentLength);
+    buffer.remove(0, bodyStart + contentLength);
+    m_busy.insert(socket);
+
+    auto response = std::make_shared<Response>(respond(request));
+    if (m_options.log) {
+        qInfo("%s -> %d%s, %lld bytes up", request.path.constData(), response->status,
+              response->streaming ? " streamed" : "", qlonglong(request.body.size()));
+    }
+
+    QPointer<QTcpSocket> guarded(socket);
+    const bool keepAlive = request.keepAlive;
+    QTimer::singleShot(response->delayMs, this, [this, guarded, response, keepAlive]() {
+        if (!guarded)
+            return;
+        QByteArray head = "HTTP/1.1 " + QByteArray::number(response->status) + " "
+                          + statusText(response->status) + "\r\n"
+                          + "Content-Type: " + response->contentType + "\r\n";
+        if (response->streaming)
+            head += "Transfer-Encoding: chunked\r\n";
+        else
+            head += "Content-Length: " + QByteArray::number(qulonglong(response->events.front().size())) + "\r\n";
+        head += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+        if (!response->streaming) {
+            guarded->write(head + QByteArray::fromStdString(response->events.front()));
+            finishExchange(guarded, keepAlive);
+            return;
+        }
+        guarded->write(head);
+        sendEvents(guarded, response, 0, keepAlive);
+    });
+}
+
+MockProvider::Response MockProvider::respond(const Request &request) {
+    Response response;
+    const bool openAI = request.path.startsWith("/v1/chat/completions");
+    const bool streamingGemini = request.path.contains(":streamGenerateContent");
+    if (!openAI && !streamingGemini && !request.path.contains(":generateContent")) {
+        response.status = 404;
+        response.events = {json{{"error", {{"message", "Unknown path"}}}}.dump()};
+        return response;
+    }
+
+    response.delayMs = m_options.ttfbMs;
+    if (m_random.generateDouble() < m_options.errorRate) {
+        response.status = 500;
+        response.events = {openAI
+            ? json{{"error", {{"message", "Mock provider failure"}, {"type", "server_error"}}}}.dump()
+            : json{{"error", {{"code", 500}, {"message", "Mock provider failure"},
+                              {"status", "INTERNAL"}}}}.dump()};
+        return response;
+    }
+
+    bool truncated = false;
+    const std::string text = modelText(request, openAI, &truncated);
+    const double bytesPerSecond = m_options.tokensPerSecond * 4;
+    response.streaming = openAI ? request.body.contains("\"stream\":true") : streamingGemini;
+
+    if (!response.streaming) {
+        // A whole reply only starts once the model has finished writing it
+        if (bytesPerSecond > 0)
+            response.delayMs += int(text.size() * 1000 / bytesPerSecond);
+        if (openAI) {
+            json body = {{"id", "chatcmpl-mock"},
+                         {"object", "chat.completion"},
+                         {"model", "mock"},
+                         {"choices", {{{"index", 0},
+                                       {"message", {{"role", "assistant"}, {"content", text}}},
+                                       {"finish_reason", truncated ? "length" : "stop"}}}}};
+            response.events = {body.dump()};
+        } else {
+            response.events = {geminiCandidate(text, truncated ? "MAX_TOKENS" : "STOP").dump()};
+        }
+        return response;
+    }
+
+    response.contentType = "text/event-stream";
+    size_t pieceSize = UNPACED_PIECE;
+    if (bytesPerSecond > 0) {
+        response.intervalMs = STREAM_TICK_MS;
+        pieceSize = std::max<size_t>(1, size_t(bytesPerSecond * STREAM_TICK_MS / 1000));
+    }
+
+    const std::vector<std::string> pieces = splitText(text, pieceSize);
+    if (openAI) {
+        for (const std::string &piece : pieces)
+            response.events.push_back("data: " + openAIChunk(piece, nullptr).dump() + "\n\n");
+        std::string last = "data: " + openAIChunk({}, truncated ? "length" : "stop").dump() + "\n\n"
+                           + "data: [DONE]\n\n";
+        if (response.events.empty())
+            response.events.push_back(last);
+        else
+            response.events.back() += last;
+    } else {
+        // Gemini puts the finish reason on the event with the last text
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            const char *finishReason = i + 1 < pieces.size() ? nullptr
+                                       : truncated ? "MAX_TOKENS" : "STOP";
+            response.events.push_back("data: " + geminiCandidate(pieces[i], finishReason).dump() + "\r\n\r\n");
+        }
+        if (response.events.empty())
+            response.events.push_back("data: " + geminiCandidate({}, "STOP").dump() + "\r\n\r\n");
+    }
+    return response;
+}
+
+std::string MockProvider::modelText(const Request &request, bool openAI, bool *truncated) {
+    std::string text;
+    if (request.body.contains(openAI ? "\"image_url\"" : "\"inlineData\"")) {
+        text = m_replies.empty() ? std::string(R"({"blocks":[]})")
+                                 : m_replies[m_nextReply++ % m_replies.size()];
+    } else {
+        // Text-only request: AIService::linesPrompt() states how many lines it wants
+        static const QRegularExpression count("with exactly (\\d+) entries");
+        const int lines = count.match(QString::fromUtf8(request.body)).captured(1).toInt();
+        json list = json::array();
+        for (int i = 0; i < lines; ++i)
+            list.push_back("Translated line " + std::to_string(i + 1));
+        text = json{{"lines", list}}.dump();
+    }
+
+    *truncated = m_random.generateDouble() < m_options.truncateRate;
+    if (*truncated) {
+        size_t cut = text.size() * 3 / 5;
+        while (cut > 0 && isContinuationByte(text[cut]))
+            --cut;
+        text.resize(cut);
+    }
+    return text;
+}
+
+void MockProvider::sendEvents(const QPointer<QTcpSocket> &socket, std::shared_ptr<Response> response,
+                              size_t next, bool keepAlive) {
+    if (!socket)
+        return;
+
+    do {
+        const std::string &event = response->events[next++];
+        socket->write(QByteArray::number(qulonglong(event.size()), 16) + "\r\n"
+                      + QByteArray::fromStdString(event) + "\r\n");
+    } while (response->intervalMs == 0 && next < response->events.size());
+
+    if (next < response->events.size()) {
+        QTimer::singleShot(response->intervalMs, this, [this, socket, response, next, keepAlive]() {
+            sendEvents(socket, response, next, keepAlive);
+        });
+        return;
+    }
+    socket->write("0\r\n\r\n");
+    finishExchange(socket, keepAlive);
+}
+
+void MockProvider::finishExchange(const QPointer<QTcpSocket> &socket, bool keepAlive) {
+    if (!socket)
+        return;
+    if (!keepAlive) {
+        socket->disconnectFromHost();
+        return;
+    }
+    m_busy.remove(socket.data());
+    if (!m_buffers.value(socket.data()).isEmpty() || socket->bytesAvailable() > 0)
+        readRequests(socket.data());
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QString>
+#include <memory>
+#include <string>
+#include <vector>
+
+class QTcpServer;
+class QTcpSocket;
+
+// Local stand-in for the providers: answers OpenAI /v1/chat/completions and
+// Gemini :generateContent / :streamGenerateContent over plain HTTP/1.1 with
+// keep-alive, so the real backends and both transports can be driven
+// without a network. Vision requests get the canned replies in turn; text-
+// only requests get one made-up line per line asked for. Pacing, failures
+// and truncation are configurable and drawn from a seeded generator.
+class MockProvider : public QObject {
+    Q_OBJECT
+public:
+    struct Options {
+        int ttfbMs = 0;              // until the response headers
+        double tokensPerSecond = 0;  // output rate, 4 bytes a token; 0 is unpaced
+        double errorRate = 0;        // fraction answered with HTTP 500
+        double truncateRate = 0;     // fraction cut off as if by the token limit
+        quint32 seed = 1;
+        bool log = false;            // one line per request on stderr
+    };
+
+    explicit MockProvider(const Options &options, QObject *parent = nullptr);
+
+    // Port 0 picks a free one
+    bool listen(quint16 port = 0);
+    quint16 port() const;
+    QString baseUrl() const;
+
+    void setOptions(const Options &options);
+    // Model output, e.g. {"blocks":[...]}, served round-robin
+    void setReplies(std::vector<std::string> replies);
+
+private:
+    struct Request {
+        QByteArray path;
+        QByteArray body;
+        bool keepAlive = true;
+    };
+
+    // What is sent back: a whole body, or SSE events paced by intervalMs
+    struct Response {
+        int status = 200;
+        QByteArray contentType = "application/json";
+        std::vector<std::string> events;
+        int delayMs = 0;     // before the headers
+        int intervalMs = 0;  // between SSE events
+        bool streaming = false;
+    };
+
+    void onNewConnection();
+    void readRequests(QTcpSocket *socket);
+    Response respond(const Request &request);
+    std::string modelText(const Request &request, bool openAI, bool *truncated);
+    void sendEvents(const QPointer<QTcpSocket> &socket, std::shared_ptr<Response> response,
+                    size_t next, bool keepAlive);
+    void finishExchange(const QPointer<QTcpSocket> &socket, bool keepAlive);
+
+    QTcpServer *m_server = nullptr;
+    Options m_options;
+    QRandomGenerator m_random;
+    std::vector<std::string> m_replies;
+    size_t m_nextReply = 0;
+    QHash<QTcpSocket *, QByteArray> m_buffers;
+    QSet<QTcpSocket *> m_busy;      // a response is still being written
+    QSet<QTcpSocket *> m_continued; // sent 100 Continue for the pending body
+
+    static constexpr int STREAM_TICK_MS = 50;
+    static constexpr size_t MAX_HEADER_BYTES = 64 * 1024;
+};
@@ -0,0 +1,81 @@
+// Serves the corpus replies as a local OpenAI/Gemini endpoint. Point the
+// app's base URL at it (e.g. http://127.0.0.1:8089) to load-test the real
+// backends on a machine without network access:
+//
+//   transIt_mockserver --ttfb 400 --tokens-per-second 60 --error-rate 0.05
+
+#include "MockProvider.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <cstdio>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// The model text of every Gemini reply in the corpus; the blocks are the
+// same in the OpenAI files
+static std::vector<std::string> loadReplies(const QString &corpus) {
+    std::vector<std::string> replies;
+    const QDir dir(corpus + "/responses");
+    for (const QString &fileName : dir.entryList({"*.gemini.json"}, QDir::Files, QDir::Name)) {
+        QFile file(dir.filePath(fileName));
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+        json reply = json::parse(file.readAll().toStdString(), nullptr, false);
+        if (reply.is_discarded())
+            continue;
+        std::string text;
+        for (const json &part : reply["candidates"][0]["content"]["parts"])
+            text += part.value("text", "");
+        replies.push_back(std::move(text));
+    }
+    return replies;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Local mock of the OpenAI and Gemini endpoints transIt uses");
+    parser.addHelpOption();
+    QCommandLineOption portOption("port", "Port on 127.0.0.1.", "port", "8089");
+    QCommandLineOption corpusOption("corpus", "Corpus directory with the canned replies.", "dir",
+                                    TRANSIT_BENCH_CORPUS);
+    QCommandLineOption ttfbOption("ttfb", "Delay before the response headers.", "ms", "0");
+    QCommandLineOption rateOption("tokens-per-second", "Output rate; 0 sends at once.", "rate", "0");
+    QCommandLineOption errorOption("error-rate", "Fraction of requests failing with HTTP 500.",
+                                   "fraction", "0");
+    QCommandLineOption truncateOption("truncate-rate", "Fraction of replies cut off at the token limit.",
+                                      "fraction", "0");
+    QCommandLineOption seedOption("seed", "Seed for failures and truncation.", "seed", "1");
+    QCommandLineOption quietOption("quiet", "Do not log requests.");
+    parser.addOptions({portOption, corpusOption, ttfbOption, rateOption, errorOption, truncateOption,
+                       seedOption, quietOption});
+    parser.process(app);
+
+    MockProvider::Options options;
+    options.ttfbMs = parser.value(ttfbOption).toInt();
+    options.tokensPerSecond = parser.value(rateOption).toDouble();
+    options.errorRate = parser.value(errorOption).toDouble();
+    options.truncateRate = parser.value(truncateOption).toDouble();
+    options.seed = parser.value(seedOption).toUInt();
+    options.log = !parser.isSet(quietOption);
+
+    std::vector<std::string> replies = loadReplies(parser.value(corpusOption));
+    if (replies.empty()) {
+        std::fprintf(stderr, "No replies in %s/responses\n", qPrintable(parser.value(corpusOption)));
+        return 1;
+    }
+
+    MockProvider provider(options);
+    provider.setReplies(std::move(replies));
+    if (!provider.listen(quint16(parser.value(portOption).toUInt()))) {
+        std::fprintf(stderr, "Cannot listen on port %s\n", qPrintable(parser.value(portOption)));
+        return 1;
+    }
+    std::fprintf(stderr, "Serving on %s\n", qPrintable(provider.baseUrl()));
+    return app.exec();
+}
@@ -0,0 +1,158 @@
+// Decoding cost of chat-completion responses with 1, 100 and 5000 blocks:
+// the previous DOM double parse against the SAX decoder, whole and streamed.
+// Damaged replies are then checked to keep their intact blocks either way.
+
+#include "ResponseParser.h"
+
+#include <QElapsedTimer>
+#include <QString>
+#include <cstdio>
+#include <functional>
+#include <initializer_list>
+#include <nlohmann/json.hpp>
+#include <string>
+
+using json = nlohmann::json;
+
+static double bestOfMs(int runs, const std::function<void()> &fn) {
+    double best = 1e300;
+    for (int r = 0; r < runs; ++r) {
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        best = qMin(best, timer.nsecsElapsed() / 1e6);
+    }
+    return best;
+}
+
+// Model output as it typically arrives: fenced despite being asked not to
+static std::string makeContent(int blocks) {
+    json list = json::array();
+    for (int i = 0; i < blocks; ++i) {
+        list.push_back({{"text", "Translated line " + std::to_string(i) + " with \"quotes\" and ünïcode"},
+                        {"x", 0.05}, {"y", (i % 100) / 100.0}, {"w", 0.9}, {"h", 0.01}});
+    }
+    return "```json\n" + json{{"blocks", list}}.dump() + "\n```";
+}
+
+static std::string makeBody(const std::string &content) {
+    return json{{"id", "chatcmpl-bench"},
+                {"object", "chat.completion"},
+                {"choices", {{{"index", 0},
+                              {"message", {{"role", "assistant"}, {"content", content}}},
+                              {"finish_reason", "stop"}}}},
+                {"usage", {{"prompt_tokens", 1000}, {"completion_tokens", 500}}}}.dump();
+}
+
+static std::string makeStream(const std::string &content) {
+    std::string stream;
+    for (size_t i = 0; i < content.size(); i += 16) {
+        json delta = {{"choices", {{{"index", 0}, {"delta", {{"content", content.substr(i, 16)}}}}}}};
+        stream += "data: " + delta.dump() + "\n\n";
+    }
+    return stream + "data: [DONE]\n\n";
+}
+
+// The decoding both backends did before ResponseParser
+static QVector<TextBlock> legacyDecode(const std::string &body) {
+    std::string content = json::parse(body)["choices"][0]["message"]["content"].get<std::string>();
+    QString raw = QString::fromStdString(content).trimmed();
+    if (raw.startsWith("```")) {
+        int firstNewline = raw.indexOf('\n');
+        int lastFence = raw.lastIndexOf("```");
+        if (firstNewline >= 0 && lastFence > firstNewline)
+            raw = raw.mid(firstNewline + 1, lastFence - firstNewline - 1).trimmed();
+    }
+
+    QVector<TextBlock> blocks;
+    json blocksJson = json::parse(raw.toStdString());
+    for (auto &b : blocksJson["blocks"]) {
+        TextBlock tb;
+        tb.text = QString::fromStdString(b["text"].get<std::string>());
+        tb.bbox = QRectF(b["x"].get<double>(), b["y"].get<double>(),
+                         b["w"].get<double>(), b["h"].get<double>());
+        blocks.append(tb);
+    }
+    return blocks;
+}
+
+// Damaged model output and the blocks that must survive it
+struct Damaged {
+    const char *name;
+    std::string content;
+    int blocks;
+    bool truncated;
+};
+
+static bool recovers(const Damaged &reply) {
+    bool truncated = false;
+    QVector<TextBlock> whole = ResponseParser::parseBlocks(reply.content, &truncated);
+
+    ResponseParser::Decoder decoder(ResponseParser::ResponseFormat::openAIChat(), true);
+    const std::string stream = makeStream(reply.content);
+    for (size_t i = 0; i < stream.size(); i += 7)
+        decoder.feed(std::string_view(stream).substr(i, 7));
+    QVector<TextBlock> streamed = decoder.finish(std::string());
+
+    return whole.size() == reply.blocks && truncated == reply.truncated
+           && streamed.size() == reply.blocks && decoder.truncated() == reply.truncated;
+}
+
+int main() {
+    std::printf("%-8s %-10s %10s %10s\n", "blocks", "decoder", "ms", "MB/s");
+
+    for (int count : {1, 100, 5000}) {
+        const std::string content = makeContent(count);
+        const std::string body = makeBody(content);
+        const std::string stream = makeStream(content);
+        const int runs = count >= 5000 ? 10 : 200;
+
+        QVector<TextBlock> legacy;
+        double legacyMs = bestOfMs(runs, [&] { legacy = legacyDecode(body); });
+
+        QVector<TextBlock> sax;
+        double saxMs = bestOfMs(runs, [&] {
+            ResponseParser::Decoder decoder(ResponseParser::ResponseFormat::openAIChat(), false);
+            sax = decoder.finish(body);
+        });
+
+        QVector<TextBlock> streamed;
+        double streamMs = bestOfMs(runs, [&] {
+            ResponseParser::Decoder decoder(ResponseParser::ResponseFormat::openAIChat(), true);
+            for (size_t i = 0; i < stream.size(); i += 1024)
+                decoder.feed(std::string_view(stream).substr(i, 1024));
+            streamed = decoder.finish(std::string());
+        });
+
+        const double mb = body.size() / (1024.0 * 1024.0);
+        const double streamMb = stream.size() / (1024.0 * 1024.0);
+        std::printf("%-8d %-10s %10.3f %10.0f\n", count, "dom", legacyMs, mb / (legacyMs / 1000));
+        std::printf("%-8d %-10s %10.3f %10.0f\n", count, "sax", saxMs, mb / (saxMs / 1000));
+        std::printf("%-8d %-10s %10.3f %10.0f\n", count, "sse", streamMs, streamMb / (streamMs / 1000));
+
+        bool matches = legacy.size() == count && sax.size() == count && streamed.size() == count;
+        for (int i = 0; matches && i < count; ++i) {
+            matches = sax[i].text == legacy[i].text && sax[i].bbox == legacy[i].bbox
+                      && streamed[i].text == legacy[i].text && streamed[i].bbox == legacy[i].bbox;
+        }
+        if (!matches) {
+            std::printf("MISMATCH at %d blocks\n", count);
+            return 1;
+        }
+    }
+
+    const std::string block = R"({"text":"kept","x":0.1,"y":0.1,"w":0.5,"h":0.05})";
+    const Damaged damaged[] = {
+        {"cut off", R"({"blocks":[)" + block + "," + block + R"(,{"text":"cu)", 2, true},
+        {"malformed", R"({"blocks":[)" + block + R"(,{"text":},)" + block + "]}", 2, false},
+        {"unbalanced", R"({"blocks":[)" + block + "}}," + block + "]}", 2, false},
+        {"stray closer", R"({"blocks":[},)" + block + "]}", 1, false},
+    };
+    for (const Damaged &reply : damaged) {
+        if (!recovers(reply)) {
+            std::printf("RECOVERY FAILED: %s\n", reply.name);
+            return 1;
+        }
+    }
+    return 0;
+}
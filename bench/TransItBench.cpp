@@ -0,0 +1,402 @@
+// Offline benchmark of the translation hot path on the checked-in corpus:
+// encoding a screenshot, base64, building each backend's request body,
+// decoding canned replies, whole requests through the backends against a
+// local mock provider, and laying out and painting the overlay. Runs on the
+// offscreen platform unless QT_QPA_PLATFORM says otherwise.
+//
+//   transIt_bench [--filter parse/] [--json results.json]
+//                 [--baseline previous.json --tolerance 0.1]
+//                 [--replay session.ttr [--replay-speed 1]]
+//
+// With --replay, replies recorded with TRANSIT_RECORD are also fed through
+// the backends, so the same code is measured on production-shaped traffic.
+
+#include "BenchHarness.h"
+#include "Base64.h"
+#include "GeminiBackend.h"
+#include "ImageEncoder.h"
+#include "MockProvider.h"
+#include "OpenAIBackend.h"
+#include "OverlayWindow.h"
+#include "RequestScheduler.h"
+#include "RequestWriter.h"
+#include "ResponseParser.h"
+#include "TrafficArchive.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QPixmap>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// A typical read size off the socket, so streamed replies arrive in pieces
+constexpr size_t NETWORK_CHUNK = 1400;
+
+struct Sample {
+    std::string name;
+    QImage image;
+    EncodedImage png;
+    std::map<std::string, std::string> replies; // "openai.json", "gemini.sse", ...
+};
+
+bool readFile(const QString &path, std::string *contents) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    *contents = file.readAll().toStdString();
+    return true;
+}
+
+std::vector<Sample> loadCorpus(const QString &dir) {
+    std::vector<Sample> samples;
+    const QStringList screenshots = QDir(dir + "/screenshots").entryList({"*.png"}, QDir::Files, QDir::Name);
+    for (const QString &fileName : screenshots) {
+        Sample sample;
+        sample.name = QFileInfo(fileName).completeBaseName().toStdString();
+        sample.image = QImage(dir + "/screenshots/" + fileName).convertToFormat(QImage::Format_RGB32);
+        if (sample.image.isNull())
+            continue;
+        sample.png = encodeImage(sample.image, {});
+        for (const char *reply : {"openai.json", "openai.sse", "gemini.json", "gemini.sse"}) {
+            std::string contents;
+            if (readFile(QString("%1/responses/%2.%3").arg(dir, QString::fromStdString(sample.name), reply),
+                         &contents))
+                sample.replies[reply] = std::move(contents);
+        }
+        samples.push_back(std::move(sample));
+    }
+    return samples;
+}
+
+QVector<TextBlock> decode(const ResponseParser::ResponseFormat &format, bool streaming,
+                          const std::string &body) {
+    ResponseParser::Decoder decoder(format, streaming);
+    if (!streaming)
+        return decoder.finish(body);
+    for (size_t i = 0; i < body.size(); i += NETWORK_CHUNK)
+        decoder.feed(std::string_view(body).substr(i, NETWORK_CHUNK));
+    return decoder.finish(std::string());
+}
+
+bool sameBlocks(const QVector<TextBlock> &a, const QVector<TextBlock> &b) {
+    if (a.size() != b.size())
+        return false;
+    for (int i = 0; i < a.size(); ++i) {
+        if (a[i].text != b[i].text || a[i].bbox != b[i].bbox)
+            return false;
+    }
+    return true;
+}
+
+void benchEncoding(BenchHarness &bench, const Sample &sample) {
+    const std::pair<const char *, EncoderSettings> encoders[] = {
+        {"png", {EncoderSettings::Format::Png, -1}},
+        {"png8", {EncoderSettings::Format::PalettePng, -1}},
+        {"jpeg", {EncoderSettings::Format::Jpeg, 85}},
+        {"webp", {EncoderSettings::Format::WebP, 80}},
+    };
+    for (const auto &encoder : encoders) {
+        const EncoderSettings &settings = encoder.second;
+        if (!isEncoderAvailable(settings.format))
+            continue;
+        EncodedImage encoded;
+        auto *result = bench.run("encode/" + sample.name + "/" + encoder.first, [&] {
+            encoded = encodeImage(sample.image, settings);
+        }, sample.image.sizeInBytes());
+        if (result)
+            result->counters["output_bytes"] = encoded.data.size();
+    }
+}
+
+void benchBase64(BenchHarness &bench, const Sample &sample) {
+    const QByteArray &input = sample.png.data;
+    const std::string reference = input.toBase64().toStdString();
+    const auto *bytes = reinterpret_cast<const unsigned char *>(input.constData());
+    std::string out(Base64::encodedSize(size_t(input.size())), '\0');
+
+    bench.run("base64/" + sample.name + "/qt", [&] {
+        QByteArray encoded = input.toBase64();
+        Q_UNUSED(encoded)
+    }, input.size());
+
+    for (auto kernel : {Base64::Kernel::Scalar, Base64::Kernel::Ssse3,
+                        Base64::Kernel::Avx2, Base64::Kernel::Avx512Vbmi}) {
+        if (!Base64::isSupported(kernel))
+            continue;
+        const std::string name = "base64/" + sample.name + "/" + Base64::kernelName(kernel);
+        if (!bench.run(name, [&] { Base64::encodeWith(kernel, bytes, size_t(input.size()), &out[0]); },
+                       input.size()))
+            continue;
+        if (out != reference)
+            bench.fail(name, "output differs from QByteArray::toBase64");
+    }
+}
+
+void benchPayloads(BenchHarness &bench, const Sample &sample) {
+    const OpenAIBackend openAI("bench-key", "http://127.0.0.1", "gpt-4o");
+    const GeminiBackend gemini("bench-key", "http://127.0.0.1", "gemini-2.0-flash");
+    const std::pair<const char *, std::function<std::string()>> payloads[] = {
+        {"openai", [&] { return openAI.visionBody(sample.png, "English"); }},
+        {"gemini", [&] { return gemini.visionBody(sample.png, "English"); }},
+    };
+    for (const auto &payload : payloads) {
+        const std::function<std::string()> &build = payload.second;
+        std::string body;
+        const std::string name = "payload/" + sample.name + "/" + payload.first;
+        auto *result = bench.run(name, [&] { body = build(); }, sample.png.data.size());
+        if (!result)
+            continue;
+        result->counters["body_bytes"] = body.size();
+        if (body.find(RequestWriter::IMAGE_PLACEHOLDER) != std::string::npos)
+            bench.fail(name, "image placeholder left in the body");
+    }
+}
+
+QVector<TextBlock> benchParsing(BenchHarness &bench, const Sample &sample) {
+    struct Reply {
+        const char *file;
+        ResponseParser::ResponseFormat format;
+        bool streaming;
+    };
+    const Reply replies[] = {
+        {"openai.json", ResponseParser::ResponseFormat::openAIChat(), false},
+        {"openai.sse", ResponseParser::ResponseFormat::openAIChat(), true},
+        {"gemini.json", ResponseParser::ResponseFormat::geminiGenerate(), false},
+        {"gemini.sse", ResponseParser::ResponseFormat::geminiGenerate(), true},
+    };
+
+    // Every reply carries the same blocks; the first one decoded is the reference
+    QVector<TextBlock> reference;
+    for (const Reply &reply : replies) {
+        auto it = sample.replies.find(reply.file);
+        if (it == sample.replies.end())
+            continue;
+        const std::string name = "parse/" + sample.name + "/" + reply.file;
+        QVector<TextBlock> blocks;
+        try {
+            blocks = decode(reply.format, reply.streaming, it->second);
+        } catch (const std::exception &e) {
+            bench.fail(name, e.what());
+            continue;
+        }
+        if (reference.isEmpty())
+            reference = blocks;
+        else if (!sameBlocks(blocks, reference))
+            bench.fail(name, "blocks differ from the other replies");
+
+        auto *result = bench.run(name, [&] {
+            blocks = decode(reply.format, reply.streaming, it->second);
+        }, it->second.size());
+        if (result)
+            result->counters["blocks"] = blocks.size();
+    }
+    return reference;
+}
+
+// Sends one capture and waits for its result; false if it failed
+bool translateAndWait(AIService *service, const EncodedImage &image, QVector<TextBlock> *blocks,
+                      QString *error) {
+    bool ok = false;
+    QEventLoop loop;
+    QObject::connect(service, &AIService::translationReady, &loop,
+                     [&](quint64, const QVector<TextBlock> &received) {
+        *blocks = received;
+        ok = true;
+        loop.quit();
+    });
+    QObject::connect(service, &AIService::translationFailed, &loop,
+                     [&](quint64, const QString &message) {
+        *error = message;
+        loop.quit();
+    });
+    if (service->translate(image, "English") != 0)
+        loop.exec();
+    return ok;
+}
+
+// The real backends, transports and scheduler against the in-process mock,
+// which answers at once: what is left is the client's own cost per request
+void benchEndToEnd(BenchHarness &bench, const Sample &sample, const QVector<TextBlock> &expected,
+                   MockProvider &provider, RequestScheduler &scheduler) {
+    auto reply = sample.replies.find("gemini.json");
+    std::string text;
+    if (reply == sample.replies.end()
+        || !ResponseParser::extractText(reply->second,
+                                        ResponseParser::ResponseFormat::geminiGenerate().content, &text))
+        return;
+    provider.setReplies({text});
+
+    OpenAIBackend openAI("bench-key", provider.baseUrl(), "gpt-4o");
+    GeminiBackend gemini("bench-key", provider.baseUrl(), "gemini-2.0-flash");
+    for (AIService *service : {static_cast<AIService *>(&openAI), static_cast<AIService *>(&gemini)}) {
+        service->setScheduler(&scheduler);
+        for (auto transport : {AIService::Transport::Curl, AIService::Transport::QtNetwork}) {
+            for (bool streaming : {false, true}) {
+                const std::string name = "e2e/" + sample.name + "/" + service->name().toLower().toStdString()
+                    + (transport == AIService::Transport::Curl ? "/curl" : "/qt")
+                    + (streaming ? "/stream" : "/whole");
+                if (!bench.wants(name))
+                    continue;
+                service->setTransport(transport);
+                service->setStreamingEnabled(streaming);
+
+                QVector<TextBlock> blocks;
+                QString error;
+                bench.run(name, [&] { translateAndWait(service, sample.png, &blocks, &error); },
+                          sample.png.data.size());
+
+                if (!error.isEmpty())
+                    bench.fail(name, error.toStdString());
+                else if (!sameBlocks(blocks, expected))
+                    bench.fail(name, "blocks differ from the canned reply");
+            }
+        }
+    }
+}
+
+// Recorded rounds served back through the backends in order, so each
+// iteration decodes the next real reply. Recorded failures are part of the
+// traffic and only counted.
+void benchReplay(BenchHarness &bench, const QVector<TrafficArchive::Round> &rounds, double speed,
+                 const Sample &sample, RequestScheduler &scheduler) {
+    OpenAIBackend openAI("bench-key", "http://127.0.0.1", "gpt-4o");
+    GeminiBackend gemini("bench-key", "http://127.0.0.1", "gemini-2.0-flash");
+    for (AIService *service : {static_cast<AIService *>(&openAI), static_cast<AIService *>(&gemini)}) {
+        const QString backend = service->name();
+        auto recorded = [&](const TrafficArchive::Round &round) { return round.backend == backend; };
+        const std::string name = "replay/" + backend.toLower().toStdString();
+        const int count = int(std::count_if(rounds.begin(), rounds.end(), recorded));
+        if (count == 0 || !bench.wants(name))
+            continue;
+
+        // The recording's settings show in its replies
+        bool streamed = false;
+        bool continued = false;
+        for (const TrafficArchive::Round &round : rounds) {
+            if (!recorded(round))
+                continue;
+            streamed = streamed || (round.statusCode == 200 && round.body.startsWith("data:"));
+            continued = continued || round.round > 0;
+        }
+        service->setScheduler(&scheduler);
+        service->setStreamingEnabled(streamed);
+        service->setContinueTruncated(continued);
+        service->setReplay(std::make_shared<TrafficArchive::Replay>(rounds, speed));
+
+        int requests = 0;
+        int failed = 0;
+        auto *result = bench.run(name, [&] {
+            QVector<TextBlock> blocks;
+            QString error;
+            ++requests;
+            if (!translateAndWait(service, sample.png, &blocks, &error))
+                ++failed;
+        });
+        if (result) {
+            result->counters["rounds"] = count;
+            result->counters["failed_fraction"] = double(failed) / requests;
+        }
+    }
+}
+
+void benchOverlay(BenchHarness &bench, const Sample &sample, const QVector<TextBlock> &blocks) {
+    if (blocks.isEmpty())
+        return;
+    OverlayWindow overlay;
+    const QRect selection(QPoint(0, 0), sample.image.size());
+
+    // showResult() decides between the positioned and the fallback layout
+    bench.run("overlay/" + sample.name + "/layout", [&] {
+        overlay.showLoading(selection);
+        overlay.showResult(blocks);
+    });
+
+    overlay.showLoading(selection);
+    overlay.showResult(blocks);
+    bench.run("overlay/" + sample.name + "/paint", [&] {
+        QPixmap pixmap = overlay.grab();
+        Q_UNUSED(pixmap)
+    });
+    overlay.hide();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Offline benchmarks of the transIt translation hot path");
+    parser.addHelpOption();
+    QCommandLineOption corpusOption("corpus", "Corpus directory.", "dir", TRANSIT_BENCH_CORPUS);
+    QCommandLineOption filterOption("filter", "Only cases whose name contains text.", "text");
+    QCommandLineOption jsonOption("json", "Write results as JSON to file ('-' for stdout).", "file");
+    QCommandLineOption baselineOption("baseline", "Fail on cases slower than in this JSON.", "file");
+    QCommandLineOption toleranceOption("tolerance", "Allowed slowdown, as a fraction.", "fraction", "0.15");
+    QCommandLineOption minTimeOption("min-time", "Time budget per case.", "ms", "200");
+    QCommandLineOption replayOption("replay", "Also replay a recorded traffic archive.", "file");
+    QCommandLineOption replaySpeedOption("replay-speed", "Scale of the recorded delays; 0 skips them.",
+                                         "factor", "0");
+    parser.addOptions({corpusOption, filterOption, jsonOption, baselineOption, toleranceOption,
+                       minTimeOption, replayOption, replaySpeedOption});
+    parser.process(app);
+
+    BenchHarness::Options options;
+    options.filter = parser.value(filterOption).toStdString();
+    options.jsonPath = parser.value(jsonOption).toStdString();
+    options.baselinePath = parser.value(baselineOption).toStdString();
+    options.tolerance = parser.value(toleranceOption).toDouble();
+    options.minTimeMs = parser.value(minTimeOption).toDouble();
+
+    const std::vector<Sample> samples = loadCorpus(parser.value(corpusOption));
+    if (samples.empty()) {
+        std::fprintf(stderr, "No screenshots in %s/screenshots\n",
+                     qPrintable(parser.value(corpusOption)));
+        return 1;
+    }
+
+    MockProvider provider(MockProvider::Options{});
+    if (!provider.listen()) {
+        std::fprintf(stderr, "Cannot start the mock provider\n");
+        return 1;
+    }
+    RequestScheduler scheduler;
+
+    QVector<TrafficArchive::Round> rounds;
+    if (parser.isSet(replayOption)) {
+        QString error;
+        if (!TrafficArchive::load(parser.value(replayOption), &rounds, &error)) {
+            std::fprintf(stderr, "Cannot read %s: %s\n", qPrintable(parser.value(replayOption)),
+                         qPrintable(error));
+            return 1;
+        }
+    }
+
+    BenchHarness bench(options);
+    for (const Sample &sample : samples) {
+        benchEncoding(bench, sample);
+        benchBase64(bench, sample);
+        benchPayloads(bench, sample);
+        const QVector<TextBlock> blocks = benchParsing(bench, sample);
+        benchEndToEnd(bench, sample, blocks, provider, scheduler);
+        benchOverlay(bench, sample, blocks);
+    }
+    if (!rounds.isEmpty())
+        benchReplay(bench, rounds, parser.value(replaySpeedOption).toDouble(), samples.front(), scheduler);
+    return bench.finish();
+}
@@ -1,3 +1,479 @@
 #include "AIService.h"
+#include "HttpSession.h"
+#include "QtHttpTransport.h"
+#include "TrafficArchive.h"
+#include "Trace.h"
+
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QUrl>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Signals always go out through the event loop and are dropped once the
+// request has been aborted
+template <typename Emit>
+static void deliver(const QPointer<AIService> &self, const RequestScheduler::AbortFlag &aborted,
+                    Emit emitSignal) {
+    if (!self) return;
+    QMetaObject::invokeMethod(self.data(), [self, aborted, emitSignal]() {
+        if (self && !aborted->isAborted())
+            emitSignal(self.data());
+    }, Qt::QueuedConnection);
+}
+
+static void fail(const QPointer<AIService> &self, quint64 requestId,
+                 const RequestScheduler::AbortFlag &aborted, const QString &error) {
+    deliver(self, aborted, [requestId, error](AIService *service) {
+        emit service->translationFailed(requestId, error);
+    });
+}
+
+static void forwardBlocks(const QPointer<AIService> &self, quint64 requestId,
+                          const RequestScheduler::AbortFlag &aborted,
+                          const QVector<TextBlock> &blocks) {
+    if (blocks.isEmpty()) return;
+    deliver(self, aborted, [requestId, blocks](AIService *service) {
+        emit service->blocksReceived(requestId, blocks);
+    });
+}
+
+// Only the first round's wait is reported; continuations are follow-ups
+static void reportTiming(const QPointer<AIService> &self, quint64 requestId,
+                         const RequestScheduler::AbortFlag &aborted, int round,
+                         const Trace::RequestTiming &timing) {
+    if (round != 0 || timing.firstByteUs < 0) return;
+    const double ms = timing.firstByteUs / 1000.0;
+    deliver(self, aborted, [requestId, ms](AIService *service) {
+        emit service->firstByteTimed(requestId, ms);
+    });
+}
+
+static void reportSent(const QPointer<AIService> &self, quint64 requestId,
+                       const RequestScheduler::AbortFlag &aborted, qint64 bytes) {
+    deliver(self, aborted, [requestId, bytes](AIService *service) {
+        emit service->requestSent(requestId, bytes);
+    });
+}
+
+// A cut-off reply is continued at most this many times
+static constexpr int MAX_CONTINUATIONS = 2;
+
+// One translate() call across its continuation rounds
+struct AIService::Exchange {
+    HttpRequest request;
+    std::shared_ptr<ResponseDecoder> decoder;
+    QVector<TextBlock> blocks; // from finished rounds
+    int round = 0;
+    int streamed = 0;          // blocks of the current round already forwarded
+    quint64 track = 0;         // trace row, the capture's batch
+    // Set while recording, with the current round's start and body pieces
+    std::shared_ptr<TrafficArchive::Recorder> recorder;
+    qint64 roundStartUs = 0;
+    QVector<qint64> chunkUs;
+    QVector<qint32> chunkEnds;
+
+    std::string body() const {
+        Trace::Span span("serialize", track);
+        return round == 0 ? request.body() : request.continuation(blocks);
+    }
+    void beginRound(qint64 startUs) {
+        roundStartUs = startUs;
+        chunkUs.clear();
+        chunkEnds.clear();
+    }
+    void feed(const QPointer<AIService> &self, quint64 requestId,
+              const RequestScheduler::AbortFlag &aborted, std::string_view chunk) {
+        if (recorder) {
+            chunkUs.append(Trace::now() - roundStartUs);
+            chunkEnds.append((chunkEnds.isEmpty() ? 0 : chunkEnds.last()) + qint32(chunk.size()));
+        }
+        QVector<TextBlock> fresh = decoder->feed(chunk);
+        streamed += fresh.size();
+        forwardBlocks(self, requestId, aborted, fresh);
+    }
+    void record(const QString &backendName, size_t requestBytes, int statusCode,
+                const std::string &text, const QString &error, bool timedOut,
+                const Trace::RequestTiming &timing) {
+        if (!recorder) return;
+        TrafficArchive::Round recorded;
+        recorded.backend = backendName;
+        recorded.endpoint = QUrl(QString::fromStdString(request.url)).path();
+        recorded.round = round;
+        recorded.requestBytes = qint64(requestBytes);
+        recorded.statusCode = statusCode;
+        recorded.error = error;
+        recorded.timedOut = timedOut;
+        recorded.firstByteUs = timing.firstByteUs;
+        recorded.endUs = timing.endUs >= 0 ? timing.endUs : Trace::now() - roundStartUs;
+        recorded.body = QByteArray::fromStdString(text);
+        recorded.chunkUs = chunkUs;
+        recorded.chunkEnds = chunkEnds;
+        recorder->append(recorded);
+    }
+};
+
+// A recorded round being played back on the service's thread
+struct AIService::Replaying {
+    QPointer<AIService> self;
+    std::shared_ptr<TrafficArchive::Replay> replay;
+    QString backendName;
+    quint64 requestId = 0;
+    RequestScheduler::AbortFlag aborted;
+    std::shared_ptr<Exchange> exchange;
+    std::function<void()> done;
+    TrafficArchive::Round round;
+    qint64 startUs = 0;
+    QElapsedTimer clock;
+};
+
+// Shared tail of both transports. Returns true when the reply was cut off
+// and another round should ask for the rest.
+bool AIService::completeRound(const QPointer<AIService> &self, quint64 requestId,
+                              const RequestScheduler::AbortFlag &aborted,
+                              const QString &backendName, int statusCode,
+                              const std::string &text, const QString &transportError,
+                              bool timedOut, Exchange &exchange) {
+    if (!transportError.isEmpty()) {
+        const QString error = QString("Request failed: %1").arg(transportError);
+        deliver(self, aborted, [requestId, error, timedOut](AIService *service) {
+            if (timedOut)
+                emit service->translationTimedOut(requestId);
+            emit service->translationFailed(requestId, error);
+        });
+        return false;
+    }
+
+    if (statusCode != 200) {
+        fail(self, requestId, aborted, QString("%1 API error (HTTP %2): %3")
+             .arg(backendName)
+             .arg(statusCode)
+             .arg(QString::fromStdString(text).left(200)));
+        return false;
+    }
+
+    try {
+        QVector<TextBlock> blocks;
+        {
+            Trace::Span span("parse", exchange.track);
+            blocks = exchange.decoder->finish(text);
+        }
+        bool truncated = exchange.decoder->truncated();
+        exchange.blocks += blocks;
+
+        if (truncated) {
+            qWarning("%s: reply cut off after %d blocks", qPrintable(backendName),
+                     int(exchange.blocks.size()));
+            // A round that completed nothing would only be cut off again
+            if (!blocks.isEmpty() && exchange.request.continuation
+                && exchange.round < MAX_CONTINUATIONS) {
+                forwardBlocks(self, requestId, aborted, blocks.mid(exchange.streamed));
+                exchange.decoder->reset();
+                exchange.streamed = 0;
+                ++exchange.round;
+                return true;
+            }
+            if (exchange.blocks.isEmpty()) {
+                fail(self, requestId, aborted,
+                     "Request failed: the reply was cut off before its first block");
+                return false;
+            }
+        }
+
+        QVector<TextBlock> all = exchange.blocks;
+        deliver(self, aborted, [requestId, all, truncated](AIService *service) {
+            if (truncated)
+                emit service->translationTruncated(requestId);
+            emit service->translationReady(requestId, all);
+        });
+    } catch (const std::exception &e) {
+        fail(self, requestId, aborted, QString("Request failed: %1").arg(e.what()));
+    }
+    return false;
+}
+
+QString AIService::continuationNote(const QVector<TextBlock> &received) {
+    const TextBlock &last = received.last();
+    json lastBlock = {
+        {"text", last.text.toStdString()},
+        {"x", last.bbox.x()}, {"y", last.bbox.y()},
+        {"w", last.bbox.width()}, {"h", last.bbox.height()}
+    };
+    return QString(
+        " Your previous reply was cut off after %1 blocks; the last complete one was %2. "
+        "Return only the blocks that come after it, in the same format."
+    ).arg(received.size()).arg(QString::fromStdString(lastBlock.dump()));
+}
+
+AIService::AIService(QObject *parent)
+    : QObject(parent), m_session(std::make_shared<HttpSession>()) {}
+
+AIService::~AIService() {
+    cancel();
+}
+
+void AIService::cancel(quint64 requestId) {
+    if (m_scheduler)
+        m_scheduler->abort(requestId);
+}
+
+void AIService::cancel() {
+    if (m_scheduler)
+        m_scheduler->abortOwnedBy(this);
+}
+
+void AIService::rebindTransport(const QString &origin, const QString &credential) {
+    m_origin = origin.toStdString();
+    m_credential = credential.toStdString();
+    m_session->rebind(m_origin, m_credential);
+    if (m_qtTransport)
+        m_qtTransport->rebind(m_origin, m_credential);
+}
+
+QString AIService::linesPrompt(const QVector<TextBlock> &lines, const QString &targetLanguage) {
+    QString prompt = QString(
+        "Translate each numbered line of text recognised on a screen to %1. "
+        "Neighbouring lines may continue the same sentence; translate them in context "
+        "but keep one entry per line. Return ONLY valid JSON, no markdown fences: "
+        "{\"lines\":[\"translation of line 1\",\"translation of line 2\"]} "
+        "with exactly %2 entries.\n"
+    ).arg(targetLanguage).arg(lines.size());
+
+    for (int i = 0; i < lines.size(); ++i)
+        prompt += QString("\n%1. %2").arg(QString::number(i + 1), lines[i].text);
+    return prompt;
+}
+
+quint64 AIService::send(const RequestScheduler::Options &options, HttpRequest request,
+                        std::shared_ptr<ResponseDecoder> decoder) {
+    if (!m_scheduler) {
+        qWarning("%s: no request scheduler set", qPrintable(name()));
+        return 0;
+    }
+    if (!m_continueTruncated)
+        request.continuation = nullptr;
+
+    auto exchange = std::make_shared<Exchange>();
+    exchange->request = std::move(request);
+    exchange->decoder = std::move(decoder);
+    exchange->track = options.batch;
+    if (m_replay)
+        return sendWithReplay(options, std::move(exchange));
+    exchange->recorder = m_recorder;
+    if (m_transport == Transport::QtNetwork)
+        return sendWithQt(options, std::move(exchange));
+    return sendWithCurl(options, std::move(exchange));
+}
+
+quint64 AIService::sendWithCurl(const RequestScheduler::Options &options,
+                                std::shared_ptr<Exchange> exchange) {
+    QPointer<AIService> self(this);
+    std::shared_ptr<HttpSession> session = m_session;
+    const QString backendName = name();
+
+    return m_scheduler->submit(this, options, [self, session, backendName, exchange](
+            quint64 requestId, const RequestScheduler::AbortFlag &aborted) {
+        try {
+            const HttpRequest &request = exchange->request;
+            cpr::Header header;
+            for (const auto &[key, value] : request.headers)
+                header.emplace(key, value);
+
+            bool another = true;
+            while (another) {
+                const std::string body = exchange->body();
+                reportSent(self, requestId, aborted, qint64(body.size()));
+                const qint64 startUs = Trace::now();
+                exchange->beginRound(startUs);
+                HttpSession::Result result = session->post(
+                    request.url, header, body, request.timeoutMs,
+                    [&](std::string_view chunk) {
+                        exchange->feed(self, requestId, aborted, chunk);
+                    },
+                    aborted->flag());
+                const cpr::Response &response = result.response;
+                Trace::recordRequest(exchange->track, startUs, result.timing);
+                reportTiming(self, requestId, aborted, exchange->round, result.timing);
+
+                if (!self || result.aborted) return;
+                QString transportError;
+                if (response.error.code != cpr::ErrorCode::OK)
+                    transportError = QString::fromStdString(response.error.message);
+                const bool timedOut = response.error.code == cpr::ErrorCode::OPERATION_TIMEDOUT;
+                exchange->record(backendName, body.size(), int(response.status_code), response.text,
+                                 transportError, timedOut, result.timing);
+                another = completeRound(self, requestId, aborted, backendName,
+                                        int(response.status_code), response.text,
+                                        transportError, timedOut, *exchange);
+            }
+        } catch (const std::exception &e) {
+            fail(self, requestId, aborted, QString("Request failed: %1").arg(e.what()));
+        }
+    });
+}
+
+quint64 AIService::sendWithQt(const RequestScheduler::Options &options,
+                              std::shared_ptr<Exchange> exchange) {
+    // One manager per backend, so concurrent requests share its HTTP/2
+    // connection instead of each holding a thread
+    if (!m_qtTransport) {
+        m_qtTransport = new QtHttpTransport(this);
+        m_qtTransport->rebind(m_origin, m_credential);
+    }
+
+    QPointer<AIService> self(this);
+    QPointer<QtHttpTransport> transport(m_qtTransport);
+    const QString backendName = name();
+
+    return m_scheduler->submitAsync(this, options, [self, transport, backendName, exchange](
+            quint64 requestId, const RequestScheduler::AbortFlag &aborted,
+            std::function<void()> done) {
+        postWithQt(self, transport, backendName, requestId, aborted, exchange, std::move(done));
+    });
+}
+
+void AIService::postWithQt(const QPointer<AIService> &self,
+                           const QPointer<QtHttpTransport> &transport,
+                           const QString &backendName, quint64 requestId,
+                           const RequestScheduler::AbortFlag &aborted,
+                           const std::shared_ptr<Exchange> &exchange,
+                           std::function<void()> done) {
+    std::string body;
+    try {
+        body = exchange->body();
+    } catch (const std::exception &e) {
+        fail(self, requestId, aborted, QString("Request failed: %1").arg(e.what()));
+        done();
+        return;
+    }
+    if (!transport || aborted->isAborted()) {
+        done();
+        return;
+    }
+
+    const HttpRequest &request = exchange->request;
+    const size_t bytes = body.size();
+    reportSent(self, requestId, aborted, qint64(bytes));
+    const qint64 startUs = Trace::now();
+    exchange->beginRound(startUs);
+    transport->post(request.url, request.headers, std::move(body), request.timeoutMs,
+        [self, requestId, aborted, exchange](std::string_view chunk) {
+            exchange->feed(self, requestId, aborted, chunk);
+        },
+        [self, transport, backendName, requestId, aborted, exchange, done, bytes, startUs](
+                const QtHttpTransport::Result &result) {
+            Trace::recordRequest(exchange->track, startUs, result.timing);
+            reportTiming(self, requestId, aborted, exchange->round, result.timing);
+            if (!result.aborted) {
+                exchange->record(backendName, bytes, result.statusCode, result.text, result.error,
+                                 result.timedOut, result.timing);
+            }
+            if (self && !result.aborted
+                && completeRound(self, requestId, aborted, backendName, result.statusCode,
+                                 result.text, result.error, result.timedOut, *exchange)) {
+                postWithQt(self, transport, backendName, requestId, aborted, exchange, done);
+                return;
+            }
+            done();
+        },
+        aborted);
+}
+
+quint64 AIService::sendWithReplay(const RequestScheduler::Options &options,
+                                  std::shared_ptr<Exchange> exchange) {
+    QPointer<AIService> self(this);
+    std::shared_ptr<TrafficArchive::Replay> replay = m_replay;
+    const QString backendName = name();
+
+    return m_scheduler->submitAsync(this, options, [self, replay, backendName, exchange](
+            quint64 requestId, const RequestScheduler::AbortFlag &aborted,
+            std::function<void()> done) {
+        replayRound(self, replay, backendName, requestId, aborted, exchange, std::move(done));
+    });
+}
+
+void AIService::replayRound(const QPointer<AIService> &self,
+                            const std::shared_ptr<TrafficArchive::Replay> &replay,
+                            const QString &backendName, quint64 requestId,
+                            const RequestScheduler::AbortFlag &aborted,
+                            const std::shared_ptr<Exchange> &exchange,
+                            std::function<void()> done) {
+    // The body is built and dropped, so serializing costs what it does live
+    try {
+        reportSent(self, requestId, aborted, qint64(exchange->body().size()));
+    } catch (const std::exception &e) {
+        fail(self, requestId, aborted, QString("Request failed: %1").arg(e.what()));
+        done();
+        return;
+    }
+
+    auto state = std::make_shared<Replaying>();
+    if (!replay->next(backendName, &state->round)) {
+        fail(self, requestId, aborted,
+             QString("Request failed: no %1 traffic in the replayed archive").arg(backendName));
+        done();
+        return;
+    }
+    state->self = self;
+    state->replay = replay;
+    state->backendName = backendName;
+    state->requestId = requestId;
+    state->aborted = aborted;
+    state->exchange = exchange;
+    state->done = std::move(done);
+    state->startUs = Trace::now();
+    state->clock.start();
+    replayFrom(state, 0);
+}
+
+// Feeds the recorded pieces of the body, then completes the round, each
+// at its recorded offset scaled by the replay speed. Steps that are due
+// run straight away; otherwise a timer resumes at the next one.
+void AIService::replayFrom(const std::shared_ptr<Replaying> &state, int step) {
+    const TrafficArchive::Round &round = state->round;
+    const int chunks = round.chunkEnds.size();
+    const double speed = state->replay->speed();
+
+    for (;;) {
+        if (!state->self || state->aborted->isAborted()) {
+            state->done();
+            return;
+        }
+
+        qint64 dueUs = step < chunks ? round.chunkUs[step] : round.endUs;
+        if (step == chunks && chunks > 0)
+            dueUs = qMax(dueUs, round.chunkUs.last());
+        const qint64 waitMs = speed > 0 ? qint64(dueUs / 1000.0 / speed) - state->clock.elapsed() : 0;
+        if (waitMs > 0) {
+            QTimer::singleShot(int(waitMs), [state, step]() { replayFrom(state, step); });
+            return;
+        }
+
+        if (step < chunks) {
+            const qint32 begin = step == 0 ? 0 : round.chunkEnds[step - 1];
+            state->exchange->feed(state->self, state->requestId, state->aborted,
+                                  std::string_view(round.body.constData() + begin,
+                                                   size_t(round.chunkEnds[step] - begin)));
+            ++step;
+            continue;
+        }
+
+        Trace::RequestTiming timing;
+        timing.firstByteUs = round.firstByteUs;
+        timing.endUs = round.endUs;
+        Trace::recordRequest(state->exchange->track, state->startUs, timing);
+        reportTiming(state->self, state->requestId, state->aborted, state->exchange->round, timing);
+        if (completeRound(state->self, state->requestId, state->aborted, state->backendName,
+                          round.statusCode, round.body.toStdString(), round.error, round.timedOut,
+                          *state->exchange)) {
+            replayRound(state->self, state->replay, state->backendName, state->requestId,
+                        state->aborted, state->exchange, std::move(state->done));
+            return;
+        }
+        state->done();
+        return;
+    }
+}
 
 #include "moc_AIService.cpp"
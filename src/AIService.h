@@ -2,27 +2,175 @@
 
 #include <QObject>
 #include <QByteArray>
+#include <QPointer>
 #include <QRectF>
 #include <QString>
 #include <QVector>
 
+#include "ImageEncoder.h"
+#include "RequestScheduler.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class HttpSession;
+class QtHttpTransport;
+namespace TrafficArchive {
+class Recorder;
+class Replay;
+}
+
 struct TextBlock {
     QString text;
     QRectF bbox; // normalized 0.0-1.0 relative to image dimensions
 };
 
+// Base of the provider backends. Subclasses describe the HTTP request and
+// how to decode its response; sending, cancellation and signalling live here
+// so both transports behave identically.
 class AIService : public QObject {
     Q_OBJECT
 public:
-    explicit AIService(QObject *parent = nullptr) : QObject(parent) {}
-    virtual ~AIService() = default;
+    enum class Transport {
+        Curl,       // blocking libcurl call on a scheduler thread
+        QtNetwork   // event-driven QNetworkAccessManager, HTTP/2 when offered
+    };
+
+    // Turns one response into blocks. A fresh decoder is made per request
+    // and is only used from one thread at a time.
+    class ResponseDecoder {
+    public:
+        virtual ~ResponseDecoder() = default;
+        // Body bytes of a successful response as they arrive; returns the
+        // blocks they complete
+        virtual QVector<TextBlock> feed(std::string_view) { return {}; }
+        // The complete body; throws on content that cannot be decoded
+        virtual QVector<TextBlock> finish(const std::string &body) = 0;
+        // Whether finish() recovered the blocks of a reply that was cut off
+        virtual bool truncated() const { return false; }
+        // Called before the response to a continuation request arrives
+        virtual void reset() {}
+    };
+
+    explicit AIService(QObject *parent = nullptr);
+    virtual ~AIService();
 
     virtual QString name() const = 0;
-    virtual void translate(const QByteArray &pngImageData,
-                           const QString &targetLanguage) = 0;
-    virtual void cancel() {}
+    virtual void reconfigure(const QString &apiKey, const QString &baseUrl,
+                             const QString &modelName) = 0;
+
+    // Submits a request to the scheduler and returns its id, which tags the
+    // signals below. Returns 0 if no scheduler has been set.
+    virtual quint64 translate(const EncodedImage &image,
+                              const QString &targetLanguage,
+                              const RequestScheduler::Options &options = {}) = 0;
+    // Text recognised locally, one block per line; the reply's translations
+    // keep each line's box. Much cheaper than sending the pixels.
+    virtual quint64 translateLines(const QVector<TextBlock> &lines,
+                                   const QString &targetLanguage,
+                                   const RequestScheduler::Options &options = {}) = 0;
+
+    // Aborts one request, or every request this service has in flight
+    virtual void cancel(quint64 requestId);
+    virtual void cancel();
+
+    void setScheduler(RequestScheduler *scheduler) { m_scheduler = scheduler; }
+    void setTransport(Transport transport) { m_transport = transport; }
+    Transport transport() const { return m_transport; }
+
+    // Request a streamed response where the backend supports it
+    void setStreamingEnabled(bool enabled) { m_streaming = enabled; }
+    bool streamingEnabled() const { return m_streaming; }
+
+    // Ask for the missing remainder when a reply is cut off by the output
+    // token limit, rather than settling for the blocks that arrived
+    void setContinueTruncated(bool enabled) { m_continueTruncated = enabled; }
+
+    // Every response and its timing is appended to the archive
+    void setRecorder(std::shared_ptr<TrafficArchive::Recorder> recorder) { m_recorder = std::move(recorder); }
+    // Responses come from the archive instead of the network; requests are
+    // still built, so only the transport is replaced
+    void setReplay(std::shared_ptr<TrafficArchive::Replay> replay) { m_replay = std::move(replay); }
 
 signals:
-    void translationReady(const QVector<TextBlock> &blocks);
-    void translationFailed(const QString &errorMessage);
+    // Newly completed blocks of a streamed response, emitted before
+    // translationReady (which still carries the full list).
+    void blocksReceived(quint64 requestId, const QVector<TextBlock> &blocks);
+    void translationReady(quint64 requestId, const QVector<TextBlock> &blocks);
+    // The reply was cut off and translationReady, which follows, only
+    // carries the blocks completed before that point
+    void translationTruncated(quint64 requestId);
+    void translationFailed(quint64 requestId, const QString &errorMessage);
+    // The transport gave up waiting; translationFailed follows
+    void translationTimedOut(quint64 requestId);
+    // Time from handing the first round to the transport until the response
+    // headers arrived
+    void firstByteTimed(quint64 requestId, double ms);
+    // Size of each round's request body, continuations included
+    void requestSent(quint64 requestId, qint64 bytes);
+
+protected:
+    struct HttpRequest {
+        std::string url;
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::function<std::string()> body; // built on whichever thread sends
+        // Body asking only for what follows the blocks received so far,
+        // sent to the same url when a reply is cut off
+        std::function<std::string(const QVector<TextBlock> &received)> continuation;
+        int timeoutMs = 30000;
+    };
+
+    // Sends over the selected transport and emits the signals above
+    quint64 send(const RequestScheduler::Options &options, HttpRequest request,
+                 std::shared_ptr<ResponseDecoder> decoder);
+    void rebindTransport(const QString &origin, const QString &credential);
+
+    // Appended to the prompt of a continuation request
+    static QString continuationNote(const QVector<TextBlock> &received);
+    // Prompt of a text-only request, asking for a {"lines":[...]} reply
+    static QString linesPrompt(const QVector<TextBlock> &lines, const QString &targetLanguage);
+
+    bool m_streaming = false;
+
+private:
+    struct Exchange;
+    struct Replaying;
+
+    static bool completeRound(const QPointer<AIService> &self, quint64 requestId,
+                              const RequestScheduler::AbortFlag &aborted,
+                              const QString &backendName, int statusCode,
+                              const std::string &text, const QString &transportError,
+                              bool timedOut, Exchange &exchange);
+    static void postWithQt(const QPointer<AIService> &self,
+                           const QPointer<QtHttpTransport> &transport,
+                           const QString &backendName, quint64 requestId,
+                           const RequestScheduler::AbortFlag &aborted,
+                           const std::shared_ptr<Exchange> &exchange,
+                           std::function<void()> done);
+    quint64 sendWithCurl(const RequestScheduler::Options &options,
+                         std::shared_ptr<Exchange> exchange);
+    quint64 sendWithQt(const RequestScheduler::Options &options,
+                       std::shared_ptr<Exchange> exchange);
+    quint64 sendWithReplay(const RequestScheduler::Options &options,
+                           std::shared_ptr<Exchange> exchange);
+    static void replayRound(const QPointer<AIService> &self,
+                            const std::shared_ptr<TrafficArchive::Replay> &replay,
+                            const QString &backendName, quint64 requestId,
+                            const RequestScheduler::AbortFlag &aborted,
+                            const std::shared_ptr<Exchange> &exchange,
+                            std::function<void()> done);
+    static void replayFrom(const std::shared_ptr<Replaying> &state, int step);
+
+    QPointer<RequestScheduler> m_scheduler;
+    Transport m_transport = Transport::Curl;
+    bool m_continueTruncated = false;
+    std::shared_ptr<HttpSession> m_session;
+    QtHttpTransport *m_qtTransport = nullptr;
+    std::shared_ptr<TrafficArchive::Recorder> m_recorder;
+    std::shared_ptr<TrafficArchive::Replay> m_replay;
+    std::string m_origin;
+    std::string m_credential;
 };
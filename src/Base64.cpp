@@ -0,0 +1,237 @@
+#include "Base64.h"
+
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TRANSIT_BASE64_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang need per-function target attributes to emit wider
+// instructions than the baseline; MSVC accepts the intrinsics as-is.
+#if defined(TRANSIT_BASE64_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TRANSIT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define TRANSIT_TARGET(isa)
+#endif
+
+namespace Base64 {
+
+static const char ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Encodes the remainder after the vector loops, including padding
+static void encodeScalar(const unsigned char *input, size_t size, char *output) {
+    size_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        unsigned v = (unsigned(input[i]) << 16) | (unsigned(input[i + 1]) << 8) | input[i + 2];
+        *output++ = ALPHABET[(v >> 18) & 0x3f];
+        *output++ = ALPHABET[(v >> 12) & 0x3f];
+        *output++ = ALPHABET[(v >> 6) & 0x3f];
+        *output++ = ALPHABET[v & 0x3f];
+    }
+
+    if (size - i == 1) {
+        unsigned v = unsigned(input[i]) << 16;
+        *output++ = ALPHABET[(v >> 18) & 0x3f];
+        *output++ = ALPHABET[(v >> 12) & 0x3f];
+        *output++ = '=';
+        *output++ = '=';
+    } else if (size - i == 2) {
+        unsigned v = (unsigned(input[i]) << 16) | (unsigned(input[i + 1]) << 8);
+        *output++ = ALPHABET[(v >> 18) & 0x3f];
+        *output++ = ALPHABET[(v >> 12) & 0x3f];
+        *output++ = ALPHABET[(v >> 6) & 0x3f];
+        *output++ = '=';
+    }
+}
+
+#ifdef TRANSIT_BASE64_X86
+
+// The SSSE3 and AVX2 kernels follow Muła and Lemire, "Faster Base64
+// Encoding and Decoding using AVX2 Instructions" (2018): split 3 bytes into
+// four 6-bit indices with two multiplies, then map indices to ASCII with a
+// 16-entry offset table.
+
+TRANSIT_TARGET("ssse3")
+static inline __m128i indicesToAscii128(__m128i indices) {
+    __m128i reduced = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i lessThan26 = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    reduced = _mm_or_si128(reduced, _mm_and_si128(lessThan26, _mm_set1_epi8(13)));
+    const __m128i offsets = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    return _mm_add_epi8(_mm_shuffle_epi8(offsets, reduced), indices);
+}
+
+TRANSIT_TARGET("ssse3")
+static inline __m128i splitIndices128(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+TRANSIT_TARGET("ssse3")
+static void encodeSsse3(const unsigned char *input, size_t size, char *output) {
+    size_t i = 0;
+    // Each step consumes 12 bytes but loads 16
+    for (; i + 16 <= size; i += 12, output += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output),
+                         indicesToAscii128(splitIndices128(in)));
+    }
+    encodeScalar(input + i, size - i, output);
+}
+
+TRANSIT_TARGET("avx2")
+static void encodeAvx2(const unsigned char *input, size_t size, char *output) {
+    const __m256i shuffle = _mm256_set_epi8(
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m256i offsets = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    size_t i = 0;
+    // 24 bytes per step; the upper lane loads input[i + 12 .. i + 27]
+    for (; i + 28 <= size; i += 24, output += 32) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i + 12));
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+        in = _mm256_shuffle_epi8(in, shuffle);
+        const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+
+        __m256i reduced = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i lessThan26 = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        reduced = _mm256_or_si256(reduced, _mm256_and_si256(lessThan26, _mm256_set1_epi8(13)));
+        const __m256i ascii = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, reduced), indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output), ascii);
+    }
+    encodeSsse3(input + i, size - i, output);
+}
+
+// VBMI lets one multishift pick all four 6-bit fields and one permute
+// translate them through the full 64-entry alphabet.
+TRANSIT_TARGET("avx512f,avx512bw,avx512vbmi")
+static void encodeAvx512Vbmi(const unsigned char *input, size_t size, char *output) {
+    const __m512i shuffle = _mm512_setr_epi32(
+        0x01020001, 0x04050304, 0x07080607, 0x0a0b090a,
+        0x0d0e0c0d, 0x10110f10, 0x13141213, 0x16171516,
+        0x191a1819, 0x1c1d1b1c, 0x1f201e1f, 0x22232122,
+        0x25262425, 0x28292728, 0x2b2c2a2b, 0x2e2f2d2e);
+    const __m512i alphabet = _mm512_loadu_si512(ALPHABET);
+    const __m512i fieldShifts = _mm512_set1_epi64(0x3036242a1016040aLL);
+
+    size_t i = 0;
+    // 48 bytes per step, loading 64
+    for (; i + 64 <= size; i += 48, output += 64) {
+        __m512i in = _mm512_loadu_si512(input + i);
+        in = _mm512_permutexvar_epi8(shuffle, in);
+        const __m512i indices = _mm512_multishift_epi64_epi8(fieldShifts, in);
+        _mm512_storeu_si512(output, _mm512_permutexvar_epi8(indices, alphabet));
+    }
+    encodeAvx2(input + i, size - i, output);
+}
+
+#ifdef _MSC_VER
+static bool osSavesYmm() {
+    int info[4];
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27))) // OSXSAVE
+        return false;
+    return (_xgetbv(0) & 0x6) == 0x6;
+}
+
+static bool osSavesZmm() {
+    return osSavesYmm() && (_xgetbv(0) & 0xe6) == 0xe6;
+}
+#endif
+
+bool isSupported(Kernel kernel) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    switch (kernel) {
+        case Kernel::Scalar: return true;
+        case Kernel::Ssse3: return __builtin_cpu_supports("ssse3");
+        case Kernel::Avx2: return __builtin_cpu_supports("avx2");
+        case Kernel::Avx512Vbmi:
+            return __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vbmi");
+    }
+    return false;
+#elif defined(_MSC_VER)
+    int leaf1[4];
+    int leaf7[4];
+    __cpuid(leaf1, 1);
+    __cpuidex(leaf7, 7, 0);
+    switch (kernel) {
+        case Kernel::Scalar: return true;
+        case Kernel::Ssse3: return leaf1[2] & (1 << 9);
+        case Kernel::Avx2: return (leaf7[1] & (1 << 5)) && osSavesYmm();
+        case Kernel::Avx512Vbmi:
+            return (leaf7[1] & (1 << 16)) && (leaf7[1] & (1 << 30)) && (leaf7[2] & (1 << 1))
+                && osSavesZmm();
+    }
+    return false;
+#else
+    return kernel == Kernel::Scalar;
+#endif
+}
+
+#else // !TRANSIT_BASE64_X86
+
+bool isSupported(Kernel kernel) {
+    return kernel == Kernel::Scalar;
+}
+
+#endif
+
+void encodeWith(Kernel kernel, const unsigned char *input, size_t size, char *output) {
+    switch (kernel) {
+#ifdef TRANSIT_BASE64_X86
+        case Kernel::Avx512Vbmi: encodeAvx512Vbmi(input, size, output); return;
+        case Kernel::Avx2: encodeAvx2(input, size, output); return;
+        case Kernel::Ssse3: encodeSsse3(input, size, output); return;
+#endif
+        default: encodeScalar(input, size, output); return;
+    }
+}
+
+Kernel activeKernel() {
+    static const Kernel kernel = [] {
+        for (Kernel k : {Kernel::Avx512Vbmi, Kernel::Avx2, Kernel::Ssse3}) {
+            if (isSupported(k))
+                return k;
+        }
+        return Kernel::Scalar;
+    }();
+    return kernel;
+}
+
+const char *kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar: return "scalar";
+        case Kernel::Ssse3: return "ssse3";
+        case Kernel::Avx2: return "avx2";
+        case Kernel::Avx512Vbmi: return "avx512vbmi";
+    }
+    return "unknown";
+}
+
+void encode(const unsigned char *input, size_t size, char *output) {
+    encodeWith(activeKernel(), input, size, output);
+}
+
+} // namespace Base64
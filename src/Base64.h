@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+// Base64 encoder for image payloads. encode() picks the widest kernel the
+// CPU supports at first use (AVX-512 VBMI, AVX2, SSSE3) and falls back to
+// scalar code elsewhere; all kernels produce identical output.
+namespace Base64 {
+
+enum class Kernel {
+    Scalar,
+    Ssse3,
+    Avx2,
+    Avx512Vbmi
+};
+
+constexpr size_t encodedSize(size_t inputSize) { return (inputSize + 2) / 3 * 4; }
+
+// Standard alphabet with '=' padding; writes exactly encodedSize(size) bytes
+void encode(const unsigned char *input, size_t size, char *output);
+
+Kernel activeKernel();
+bool isSupported(Kernel kernel);
+const char *kernelName(Kernel kernel);
+
+// Forces a specific kernel; used by the benchmark. Must be supported.
+void encodeWith(Kernel kernel, const unsigned char *input, size_t size, char *output);
+
+} // namespace Base64
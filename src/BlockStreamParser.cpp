@@ -0,0 +1,85 @@
+#include "BlockStreamParser.h"
+#include "ResponseParser.h"
+
+static constexpr std::string_view BLOCKS_KEY = "\"blocks\"";
+
+QVector<TextBlock> BlockStreamParser::feed(std::string_view text) {
+    QVector<TextBlock> completed;
+    if (m_state == State::Done)
+        return completed;
+
+    m_buffer.append(text);
+
+    if (m_state == State::SeekingArray) {
+        size_t key = m_buffer.find(BLOCKS_KEY.data(), m_scan, BLOCKS_KEY.size());
+        size_t bracket = key == std::string::npos
+            ? std::string::npos : m_buffer.find('[', key + BLOCKS_KEY.size());
+        if (bracket == std::string::npos) {
+            // Rescan the tail next time in case the key is split across chunks
+            if (key != std::string::npos)
+                m_scan = key;
+            else if (m_buffer.size() > BLOCKS_KEY.size())
+                m_scan = m_buffer.size() - BLOCKS_KEY.size();
+            return completed;
+        }
+        m_scan = bracket + 1;
+        m_state = State::InArray;
+    }
+
+    for (; m_scan < m_buffer.size(); ++m_scan) {
+        char c = m_buffer[m_scan];
+
+        if (m_inString) {
+            if (m_escaped)
+                m_escaped = false;
+            else if (c == '\\')
+                m_escaped = true;
+            else if (c == '"')
+                m_inString = false;
+            continue;
+        }
+
+        if (c == '"') {
+            m_inString = true;
+        } else if (c == '{' || c == '[') {
+            if (m_depth == 0)
+                m_objectStart = m_scan;
+            ++m_depth;
+        } else if (c == ']' && m_depth == 0) {
+            m_state = State::Done;
+            break;
+        } else if (c == '}' || c == ']') {
+            // A stray closer between blocks is malformed output, not the end
+            // of one
+            if (m_depth == 0 || m_objectStart == std::string::npos)
+                continue;
+            if (--m_depth > 0)
+                continue;
+
+            TextBlock tb;
+            bool parsed = ResponseParser::parseBlock(
+                std::string_view(m_buffer).substr(m_objectStart, m_scan + 1 - m_objectStart), &tb);
+            m_objectStart = std::string::npos;
+            if (!parsed)
+                continue;
+
+            m_blocks.append(tb);
+            completed.append(tb);
+        }
+    }
+
+    compact();
+    return completed;
+}
+
+void BlockStreamParser::compact() {
+    // Drop everything before the object currently being assembled
+    size_t keepFrom = m_objectStart == std::string::npos ? m_scan : m_objectStart;
+    if (keepFrom == 0)
+        return;
+
+    m_buffer.erase(0, keepFrom);
+    m_scan -= keepFrom;
+    if (m_objectStart != std::string::npos)
+        m_objectStart -= keepFrom;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "AIService.h"
+#include <string>
+#include <string_view>
+
+// Pulls complete {"text","x","y","w","h"} objects out of a partially
+// generated {"blocks":[...]} document as the model streams it, so blocks
+// can be shown before the closing bracket arrives. Markdown fences and
+// other text around the array are skipped.
+class BlockStreamParser {
+public:
+    // Appends model output and returns the blocks completed by it.
+    QVector<TextBlock> feed(std::string_view text);
+
+    // True once the closing bracket of the blocks array has been seen.
+    bool isComplete() const { return m_state == State::Done; }
+    const QVector<TextBlock> &blocks() const { return m_blocks; }
+
+private:
+    enum class State { SeekingArray, InArray, Done };
+
+    void compact();
+
+    std::string m_buffer;
+    size_t m_scan = 0;
+    size_t m_objectStart = std::string::npos;
+    int m_depth = 0;
+    bool m_inString = false;
+    bool m_escaped = false;
+    State m_state = State::SeekingArray;
+    QVector<TextBlock> m_blocks;
+};
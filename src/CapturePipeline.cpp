@@ -0,0 +1,138 @@
+#include "CapturePipeline.h"
+#include "ImageTiler.h"
+#include "Trace.h"
+
+#include <QElapsedTimer>
+#include <QtConcurrent>
+
+// Enough for a line of text cut by one tile to be whole in its neighbour
+static constexpr int TILE_OVERLAP = 96;
+
+static QVector<CapturePipeline::Tile> encodeTiles(QImage image, const EncoderSettings &encoder,
+                                                  int tileEdge) {
+    double scale = ImageTiler::fitScale(image.size(), tileEdge, TILE_OVERLAP,
+                                        CapturePipeline::MAX_TILES);
+    if (scale < 1.0) {
+        image = image.scaled(image.size() * scale, Qt::IgnoreAspectRatio,
+                             Qt::SmoothTransformation);
+    }
+
+    const QVector<QRect> rects = ImageTiler::plan(image.size(), tileEdge, TILE_OVERLAP);
+    return QtConcurrent::blockingMapped<QVector<CapturePipeline::Tile>>(
+        rects, [image, encoder](const QRect &rect) {
+            CapturePipeline::Tile tile;
+            tile.area = ImageTiler::normalizedArea(rect, image.size());
+            tile.encoded = encodeImage(image.copy(rect), encoder);
+            return tile;
+        });
+}
+
+CapturePipeline::CapturePipeline(QObject *parent)
+    : QObject(parent), m_ocr(std::make_shared<LocalOcr>()) {}
+
+CapturePipeline::~CapturePipeline() {
+    cancel();
+}
+
+quint64 CapturePipeline::compose(const QRect &region, const RegionGrab &grab,
+                                 const CacheContext &cache, bool supersede) {
+    const quint64 serial = ++m_lastId;
+    if (supersede)
+        m_dropBefore = serial;
+    QPointer<CapturePipeline> self(this);
+    QElapsedTimer clock;
+    clock.start();
+
+    m_future = QtConcurrent::run([self, serial, region, grab, cache, clock]() {
+        auto capture = std::make_shared<Capture>();
+        capture->clock = clock;
+        capture->id = serial;
+        capture->region = region;
+        capture->targetLanguage = cache.targetLanguage;
+
+        {
+            Trace::Span span("compose", serial);
+            capture->image = grab.stitch(region.size());
+        }
+
+        if (!cache.backend.isEmpty()) {
+            if (!self || self->isStale(serial)) return;
+            Trace::Span span("hash", serial);
+            capture->cacheQuery = TranslationCache::makeQuery(
+                capture->image, cache.targetLanguage, cache.backend, cache.model,
+                cache.withFingerprint);
+        }
+
+        if (!self) return;
+        QMetaObject::invokeMethod(self.data(), [self, serial, capture]() {
+            if (self && !self->isStale(serial))
+                emit self->composed(capture);
+        }, Qt::QueuedConnection);
+    });
+    return serial;
+}
+
+void CapturePipeline::encode(const Handle &capture, const PreprocessOptions &preprocess,
+                             const EncoderSettings &encoder, int tileEdge) {
+    if (!capture || isStale(capture->id))
+        return;
+
+    // The worker fills in a copy so the caller's handle is never written
+    // behind its back; the pixel data itself stays shared
+    const quint64 serial = capture->id;
+    auto next = std::make_shared<Capture>(*capture);
+    QPointer<CapturePipeline> self(this);
+
+    m_future = QtConcurrent::run([self, serial, next, preprocess, encoder, tileEdge]() {
+        QImage prepared;
+        {
+            Trace::Span span("preprocess", serial);
+            prepared = preprocessCapture(next->image, preprocess);
+        }
+
+        if (!self || self->isStale(serial)) return;
+        {
+            Trace::Span span("encode", serial);
+            if (tileEdge > 0 && qMax(prepared.width(), prepared.height()) > tileEdge)
+                next->tiles = encodeTiles(prepared, encoder, tileEdge);
+            else
+                next->encoded = encodeImage(prepared, encoder);
+        }
+
+        if (!self) return;
+        QMetaObject::invokeMethod(self.data(), [self, serial, next]() {
+            if (self && !self->isStale(serial))
+                emit self->encoded(next);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void CapturePipeline::recognize(const Handle &capture, const QString &languages) {
+    if (!capture || isStale(capture->id))
+        return;
+
+    const quint64 serial = capture->id;
+    auto next = std::make_shared<Capture>(*capture);
+    QPointer<CapturePipeline> self(this);
+    std::shared_ptr<LocalOcr> ocr = m_ocr;
+
+    m_future = QtConcurrent::run([self, serial, next, ocr, languages]() {
+        QString error;
+        {
+            Trace::Span span("ocr", serial);
+            next->lines = ocr->recognize(next->image, languages, &error);
+        }
+        if (!error.isEmpty())
+            qWarning("Capture: %s", qPrintable(error));
+
+        if (!self) return;
+        QMetaObject::invokeMethod(self.data(), [self, serial, next]() {
+            if (self && !self->isStale(serial))
+                emit self->recognized(next);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void CapturePipeline::cancel() {
+    m_dropBefore = m_lastId + 1;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ImageEncoder.h"
+#include "ImagePreprocessor.h"
+#include "LocalOcr.h"
+#include "RegionSelector.h"
+#include "TranslationCache.h"
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QObject>
+#include <QPointer>
+#include <atomic>
+#include <memory>
+
+// Runs the pixel work of a capture on the thread pool so the GUI thread only
+// grabs the screens and later receives a handle that is ready to send.
+//
+// Work is split in two stages so a cache hit never pays for encoding:
+// compose() stitches the grabs and computes the cache key, then encode()
+// preprocesses and compresses the image once the caller knows it needs it
+// (or recognize() reads its text locally).
+// A superseding capture or cancel() drops older results still in flight.
+class CapturePipeline : public QObject {
+    Q_OBJECT
+public:
+    // What the cache key is computed for; an empty backend skips hashing
+    struct CacheContext {
+        QString targetLanguage;
+        QString backend;
+        QString model;
+        bool withFingerprint = false;
+    };
+
+    struct Tile {
+        QRectF area; // normalized, within the whole capture
+        EncodedImage encoded;
+    };
+
+    struct Capture {
+        quint64 id = 0;
+        QRect region;
+        QString targetLanguage;
+        QImage image;
+        TranslationCache::Query cacheQuery;
+        EncodedImage encoded;
+        QVector<Tile> tiles; // filled instead of encoded for a tiled capture
+        QVector<TextBlock> lines; // recognised locally, untranslated
+        QElapsedTimer clock; // started when the selection was made
+    };
+    using Handle = std::shared_ptr<Capture>;
+
+    // Beyond this many tiles a capture is scaled down rather than split further
+    static constexpr int MAX_TILES = 12;
+
+    explicit CapturePipeline(QObject *parent = nullptr);
+    ~CapturePipeline() override;
+
+    // Returns the id the capture will carry through both stages
+    quint64 compose(const QRect &region, const RegionGrab &grab, const CacheContext &cache,
+                    bool supersede);
+    // With tileEdge set, a prepared image larger than that is split into
+    // overlapping tiles that are encoded concurrently
+    void encode(const Handle &capture, const PreprocessOptions &preprocess,
+                const EncoderSettings &encoder, int tileEdge = 0);
+    // Alternative second stage: offline OCR instead of encoding
+    void recognize(const Handle &capture, const QString &languages);
+    void cancel();
+
+signals:
+    void composed(const CapturePipeline::Handle &capture);
+    void encoded(const CapturePipeline::Handle &capture);
+    void recognized(const CapturePipeline::Handle &capture);
+
+private:
+    bool isStale(quint64 id) const { return id < m_dropBefore; }
+
+    std::atomic<quint64> m_lastId{0};
+    std::atomic<quint64> m_dropBefore{0};
+    QFuture<void> m_future;
+    std::shared_ptr<LocalOcr> m_ocr;
+};
@@ -0,0 +1,51 @@
+#include "FrameDiff.h"
+#include "ImageKernels.h"
+
+#include <cstring>
+
+QRect FrameDiff::update(const QImage &image) {
+    QImage frame = image.format() == QImage::Format_RGB32
+        ? image : image.convertToFormat(QImage::Format_RGB32);
+
+    if (m_previous.size() != frame.size()) {
+        m_previous = frame;
+        return frame.rect();
+    }
+
+    const int rowBytes = frame.width() * 4;
+    QRect changed;
+    for (int y = 0; y < frame.height(); y += TILE) {
+        const int bandHeight = qMin(TILE, frame.height() - y);
+
+        bool identical = true;
+        for (int row = y; row < y + bandHeight && identical; ++row)
+            identical = std::memcmp(frame.constScanLine(row), m_previous.constScanLine(row),
+                                    size_t(rowBytes)) == 0;
+        if (identical)
+            continue;
+
+        for (int x = 0; x < frame.width(); x += TILE) {
+            QRect tile(x, y, qMin(TILE, frame.width() - x), bandHeight);
+            if (tileChanged(frame, tile))
+                changed |= tile;
+        }
+    }
+
+    // Below-threshold differences stay measured against the old frame, so a
+    // slow fade still adds up to a change
+    if (!changed.isNull())
+        m_previous = frame;
+    return changed;
+}
+
+bool FrameDiff::tileChanged(const QImage &frame, const QRect &tile) const {
+    const int bytes = tile.width() * 4;
+    quint32 sum = 0;
+    for (int row = tile.top(); row <= tile.bottom(); ++row) {
+        const uchar *a = frame.constScanLine(row) + tile.x() * 4;
+        const uchar *b = m_previous.constScanLine(row) + tile.x() * 4;
+        sum += ImageKernels::absDiffBytes(a, b, bytes);
+    }
+    // Alpha bytes of RGB32 are always 0xff and never differ
+    return sum > quint32(tile.width() * tile.height() * 3 * MEAN_DIFF_THRESHOLD);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QImage>
+#include <QRect>
+
+// Tile-by-tile comparison of successive frames of a live region. Rows that
+// are byte-identical are skipped with a plain compare, so an idle screen
+// costs one pass over the frame; only bands that differ are scored per tile.
+class FrameDiff {
+public:
+    static constexpr int TILE = 32; // device pixels
+
+    // Device-pixel bounding box of the tiles that changed since the previous
+    // frame; null when none did. The first frame, or one of another size,
+    // is changed everywhere.
+    QRect update(const QImage &frame);
+    void reset() { m_previous = QImage(); }
+
+private:
+    bool tileChanged(const QImage &frame, const QRect &tile) const;
+
+    QImage m_previous; // Format_RGB32
+
+    // Mean absolute difference per colour byte above which a tile counts as
+    // changed; keeps dithering and cursor blinks from triggering requests
+    static constexpr int MEAN_DIFF_THRESHOLD = 2;
+};
@@ -0,0 +1,280 @@
+#include "HedgedService.h"
+
+#include <QTimer>
+
+// Weight of the newest result in the smoothed winning time
+static constexpr double TYPICAL_WEIGHT = 0.2;
+
+HedgedService::HedgedService(AIService *primary, const QString &primaryModel,
+                             AIService *secondary, const QString &secondaryModel,
+                             int delayMs, RequestStats *stats, QObject *parent)
+    : AIService(parent), m_services{primary, secondary}, m_models{primaryModel, secondaryModel},
+      m_delayMs(qMax(0, delayMs)), m_stats(stats)
+{
+    for (Side side : {Primary, Secondary}) {
+        m_services[side]->setParent(this);
+        connectService(side);
+    }
+}
+
+HedgedService::~HedgedService() {
+    cancel();
+}
+
+void HedgedService::reconfigure(const QString &apiKey, const QString &baseUrl,
+                                const QString &modelName) {
+    m_services[Primary]->reconfigure(apiKey, baseUrl, modelName);
+}
+
+void HedgedService::connectService(Side side) {
+    AIService *service = m_services[side];
+    connect(service, &AIService::blocksReceived, this,
+            [this, side](quint64 id, const QVector<TextBlock> &blocks) {
+                onBlocksReceived(side, id, blocks);
+            });
+    connect(service, &AIService::translationReady, this,
+            [this, side](quint64 id, const QVector<TextBlock> &blocks) {
+                onTranslationReady(side, id, blocks);
+            });
+    connect(service, &AIService::translationTruncated, this,
+            [this, side](quint64 id) { onTranslationTruncated(side, id); });
+    connect(service, &AIService::translationFailed, this,
+            [this, side](quint64 id, const QString &error) {
+                onTranslationFailed(side, id, error);
+            });
+    connect(service, &AIService::translationTimedOut, this, [this, side](quint64 id) {
+        quint64 raceId;
+        if (Race *race = findRace(side, id, &raceId))
+            race->timedOut[side] = true;
+    });
+    connect(service, &AIService::firstByteTimed, this,
+            [this, side](quint64 id, double ms) { onFirstByteTimed(side, id, ms); });
+    // Both sides' uploads count; hedging pays for the second one
+    connect(service, &AIService::requestSent, this, [this, side](quint64 id, qint64 bytes) {
+        quint64 raceId;
+        if (findRace(side, id, &raceId))
+            emit requestSent(raceId, bytes);
+    });
+}
+
+quint64 HedgedService::translate(const EncodedImage &image,
+                                 const QString &targetLanguage,
+                                 const RequestScheduler::Options &options) {
+    return startRace([image, targetLanguage, options](AIService *service) {
+        return service->translate(image, targetLanguage, options);
+    });
+}
+
+quint64 HedgedService::translateLines(const QVector<TextBlock> &lines,
+                                      const QString &targetLanguage,
+                                      const RequestScheduler::Options &options) {
+    return startRace([lines, targetLanguage, options](AIService *service) {
+        return service->translateLines(lines, targetLanguage, options);
+    });
+}
+
+quint64 HedgedService::startRace(const Start &start) {
+    pruneRaces();
+
+    quint64 raceId = start(m_services[Primary]);
+    if (raceId == 0)
+        return 0;
+
+    Race race;
+    race.start = start;
+    race.timer.start();
+    m_races.insert(raceId, race);
+
+    if (m_delayMs == 0)
+        launchSecondary(raceId);
+    else
+        QTimer::singleShot(m_delayMs, this, [this, raceId]() { launchSecondary(raceId); });
+    return raceId;
+}
+
+void HedgedService::cancel(quint64 requestId) {
+    auto it = m_races.constFind(requestId);
+    if (it == m_races.constEnd())
+        return;
+    for (Side side : {Primary, Secondary}) {
+        if (it->states[side] == State::Running)
+            m_services[side]->cancel(it->ids[side]);
+    }
+    dropRace(requestId);
+}
+
+void HedgedService::cancel() {
+    for (AIService *service : m_services)
+        service->cancel();
+    m_races.clear();
+    m_secondaryIds.clear();
+}
+
+void HedgedService::launchSecondary(quint64 raceId) {
+    auto it = m_races.find(raceId);
+    if (it == m_races.end() || it->states[Secondary] != State::Idle)
+        return;
+
+    // Both requests share the capture's batch, so neither supersedes the other
+    quint64 id = it->start(m_services[Secondary]);
+    if (id == 0) {
+        it->states[Secondary] = State::Done;
+        if (it->error.isEmpty())
+            it->error = "Could not start the hedged request.";
+        sideEnded(raceId);
+        return;
+    }
+    it->ids[Secondary] = id;
+    it->states[Secondary] = State::Running;
+    m_secondaryIds.insert(id, raceId);
+}
+
+HedgedService::Race *HedgedService::findRace(Side side, quint64 requestId, quint64 *raceId) {
+    *raceId = side == Primary ? requestId : m_secondaryIds.value(requestId);
+    auto it = m_races.find(*raceId);
+    return it == m_races.end() ? nullptr : &it.value();
+}
+
+void HedgedService::onBlocksReceived(Side side, quint64 requestId,
+                                     const QVector<TextBlock> &blocks) {
+    quint64 raceId;
+    Race *race = findRace(side, requestId, &raceId);
+    if (!race)
+        return;
+
+    // Interleaving two partial answers would garble the overlay
+    if (race->streamingSide < 0)
+        race->streamingSide = side;
+    if (race->streamingSide == side)
+        emit blocksReceived(raceId, blocks);
+}
+
+void HedgedService::onTranslationReady(Side side, quint64 requestId,
+                                       const QVector<TextBlock> &blocks) {
+    quint64 raceId;
+    Race *race = findRace(side, requestId, &raceId);
+    if (!race)
+        return;
+
+    race->states[side] = State::Done;
+    if (!race->truncated[side]) {
+        finishRace(raceId, side, blocks, false);
+        return;
+    }
+
+    // A cut-off result only wins if the other side cannot do better
+    if (race->fallbackSide < 0 || blocks.size() > race->fallback.size()) {
+        race->fallback = blocks;
+        race->fallbackSide = side;
+    }
+    sideEnded(raceId);
+}
+
+void HedgedService::onTranslationTruncated(Side side, quint64 requestId) {
+    quint64 raceId;
+    if (Race *race = findRace(side, requestId, &raceId))
+        race->truncated[side] = true;
+}
+
+void HedgedService::onTranslationFailed(Side side, quint64 requestId, const QString &error) {
+    quint64 raceId;
+    Race *race = findRace(side, requestId, &raceId);
+    if (!race)
+        return;
+
+    race->states[side] = State::Done;
+    if (side == Primary || race->error.isEmpty()) {
+        race->error = error;
+        race->errorSide = side;
+    }
+    sideEnded(raceId);
+}
+
+void HedgedService::onFirstByteTimed(Side side, quint64 requestId, double ms) {
+    quint64 raceId;
+    Race *race = findRace(side, requestId, &raceId);
+    if (!race || race->firstByteSeen)
+        return;
+
+    // Whichever side answers first; measured from that side's own send
+    race->firstByteSeen = true;
+    emit firstByteTimed(raceId, ms);
+}
+
+void HedgedService::sideEnded(quint64 raceId) {
+    auto it = m_races.find(raceId);
+    if (it == m_races.end())
+        return;
+
+    // No point waiting out the delay once the primary has come back empty
+    if (it->states[Secondary] == State::Idle) {
+        launchSecondary(raceId);
+        return;
+    }
+    if (it->states[Primary] == State::Running || it->states[Secondary] == State::Running)
+        return;
+
+    if (it->fallbackSide >= 0) {
+        QVector<TextBlock> fallback = it->fallback;
+        finishRace(raceId, Side(it->fallbackSide), fallback, true);
+        return;
+    }
+    QString error = it->error;
+    bool timedOut = it->errorSide >= 0 && it->timedOut[it->errorSide];
+    dropRace(raceId);
+    if (timedOut)
+        emit translationTimedOut(raceId);
+    emit translationFailed(raceId, error);
+}
+
+void HedgedService::finishRace(quint64 raceId, Side winner, const QVector<TextBlock> &blocks,
+                               bool truncated) {
+    Race race = m_races.value(raceId);
+    dropRace(raceId);
+
+    const Side loser = winner == Primary ? Secondary : Primary;
+    const double elapsedMs = race.timer.nsecsElapsed() / 1e6;
+    RequestStats::HedgeScore &won = m_stats->hedgeScore(m_services[winner]->name(),
+                                                        m_models[winner]);
+
+    if (race.ids[Secondary] != 0) {
+        RequestStats::HedgeScore &lost = m_stats->hedgeScore(m_services[loser]->name(),
+                                                             m_models[loser]);
+        ++won.races;
+        ++won.wins;
+        ++lost.races;
+        // The loser is aborted, so its finishing time is estimated from its
+        // own recent wins
+        double savedMs = 0;
+        if (race.states[loser] == State::Running && lost.typicalMs > 0)
+            savedMs = qMax(0.0, lost.typicalMs - elapsedMs);
+        won.savedMs += savedMs;
+    }
+    won.typicalMs = won.typicalMs == 0
+        ? elapsedMs : won.typicalMs + TYPICAL_WEIGHT * (elapsedMs - won.typicalMs);
+
+    if (race.states[loser] == State::Running)
+        m_services[loser]->cancel(race.ids[loser]);
+
+    if (truncated)
+        emit translationTruncated(raceId);
+    emit translationReady(raceId, blocks);
+}
+
+void HedgedService::dropRace(quint64 raceId) {
+    Race race = m_races.take(raceId);
+    if (race.ids[Secondary] != 0)
+        m_secondaryIds.remove(race.ids[Secondary]);
+}
+
+void HedgedService::pruneRaces() {
+    QVector<quint64> stale;
+    for (auto it = m_races.constBegin(); it != m_races.constEnd(); ++it) {
+        if (it->timer.hasExpired(STALE_RACE_MS))
+            stale.append(it.key());
+    }
+    for (quint64 raceId : stale)
+        cancel(raceId);
+}
+
+#include "moc_HedgedService.cpp"
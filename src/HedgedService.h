@@ -0,0 +1,84 @@
+#pragma once
+
+#include "AIService.h"
+#include "RequestStats.h"
+#include <QElapsedTimer>
+#include <QHash>
+
+// Sends each capture to a primary backend and, once a delay has passed
+// without a result, to a second backend or model as well. The first usable
+// result wins and the other request is aborted. Request ids are the
+// primary backend's.
+class HedgedService : public AIService {
+    Q_OBJECT
+public:
+    // Takes ownership of both services; a delay of 0 sends to both at once.
+    // Races are scored in stats, under each service's name and model.
+    HedgedService(AIService *primary, const QString &primaryModel,
+                  AIService *secondary, const QString &secondaryModel,
+                  int delayMs, RequestStats *stats, QObject *parent = nullptr);
+    ~HedgedService() override;
+
+    // The primary's name, so cached results stay shared with unhedged use
+    QString name() const override { return m_services[Primary]->name(); }
+    void reconfigure(const QString &apiKey, const QString &baseUrl,
+                     const QString &modelName) override;
+    quint64 translate(const EncodedImage &image,
+                      const QString &targetLanguage,
+                      const RequestScheduler::Options &options = {}) override;
+    quint64 translateLines(const QVector<TextBlock> &lines,
+                           const QString &targetLanguage,
+                           const RequestScheduler::Options &options = {}) override;
+    void cancel(quint64 requestId) override;
+    void cancel() override;
+
+    AIService *primary() const { return m_services[Primary]; }
+    AIService *secondary() const { return m_services[Secondary]; }
+
+private:
+    enum Side { Primary, Secondary };
+    enum class State { Idle, Running, Done };
+
+    // Sends the race's request to one of the two services
+    using Start = std::function<quint64(AIService *service)>;
+
+    struct Race {
+        Start start;
+        QElapsedTimer timer;
+        quint64 ids[2] = {0, 0};
+        State states[2] = {State::Running, State::Idle};
+        bool truncated[2] = {false, false};
+        bool timedOut[2] = {false, false};
+        bool firstByteSeen = false;
+        int streamingSide = -1;   // the only side whose partial blocks are shown
+        // A truncated result, kept in case the other side fails
+        QVector<TextBlock> fallback;
+        int fallbackSide = -1;
+        QString error;
+        int errorSide = -1;
+    };
+
+    void connectService(Side side);
+    quint64 startRace(const Start &start);
+    void launchSecondary(quint64 raceId);
+    Race *findRace(Side side, quint64 requestId, quint64 *raceId);
+    void onBlocksReceived(Side side, quint64 requestId, const QVector<TextBlock> &blocks);
+    void onTranslationReady(Side side, quint64 requestId, const QVector<TextBlock> &blocks);
+    void onTranslationTruncated(Side side, quint64 requestId);
+    void onTranslationFailed(Side side, quint64 requestId, const QString &error);
+    void onFirstByteTimed(Side side, quint64 requestId, double ms);
+    void sideEnded(quint64 raceId); // a side finished without winning
+    void finishRace(quint64 raceId, Side winner, const QVector<TextBlock> &blocks, bool truncated);
+    void dropRace(quint64 raceId);
+    void pruneRaces();
+
+    AIService *m_services[2];
+    QString m_models[2];
+    int m_delayMs;
+    QHash<quint64, Race> m_races;           // by primary request id
+    QHash<quint64, quint64> m_secondaryIds; // secondary request id -> race
+    RequestStats *m_stats;
+
+    // Races a supersede aborted underneath us never report back
+    static constexpr qint64 STALE_RACE_MS = 5 * 60 * 1000;
+};
@@ -0,0 +1,103 @@
+#include "HttpSession.h"
+
+#include <curl/curl.h>
+
+void HttpSession::rebind(const std::string &origin, const std::string &credential) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (origin == m_origin && credential == m_credential)
+        return;
+
+    m_origin = origin;
+    m_credential = credential;
+    ++m_generation;
+    m_idle.reset();
+}
+
+HttpSession::Result HttpSession::post(const std::string &url, const cpr::Header &header,
+                                      std::string body, int timeoutMs,
+                                      const DataCallback &onData,
+                                      const std::atomic<bool> *abortFlag) {
+    // Take the warm session out of the slot. A second request issued while
+    // the first is still in flight gets a cold session instead of waiting.
+    std::shared_ptr<cpr::Session> session;
+    std::uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        session = std::move(m_idle);
+        generation = m_generation;
+    }
+    if (!session)
+        session = makeSession();
+
+    session->SetUrl(cpr::Url{url});
+    session->SetHeader(header);
+    session->SetBody(cpr::Body{std::move(body)});
+    session->SetTimeout(cpr::Timeout{timeoutMs});
+
+    // The body is always collected through a write callback so that warm
+    // sessions behave the same for streamed and buffered requests.
+    CURL *handle = session->GetCurlHolder()->handle;
+    std::string received;
+    auto keepGoing = [abortFlag]() { return !abortFlag || !abortFlag->load(); };
+    session->SetWriteCallback(cpr::WriteCallback{
+        [handle, &received, &onData, keepGoing](const auto &data, intptr_t) -> bool {
+            if (!keepGoing())
+                return false;
+            long status = 0;
+            curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+            received.append(data.data(), data.size());
+            if (onData && status == 200)
+                onData(std::string_view(data.data(), data.size()));
+            return true;
+        }});
+
+    // curl also calls this while waiting on DNS, connect or a silent server,
+    // so an abort does not have to wait for the next byte to arrive
+    session->SetProgressCallback(cpr::ProgressCallback{
+        [keepGoing](auto, auto, auto, auto, intptr_t) -> bool { return keepGoing(); }});
+
+    Result result;
+    result.response = session->Post();
+    result.response.text = std::move(received);
+    result.aborted = !keepGoing();
+
+    long newConnections = 0;
+    curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &newConnections);
+    long version = 0;
+    curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &version);
+    if (result.response.error.code == cpr::ErrorCode::OK) {
+        result.timing.connection = newConnections == 0 ? "reused" : "new";
+        result.timing.protocol = version == CURL_HTTP_VERSION_3 ? "h3"
+                                 : version == CURL_HTTP_VERSION_2_0 ? "h2" : "http/1.1";
+    }
+
+    // curl's stage times are cumulative from the start of the transfer and
+    // zero for stages a reused connection skips
+    curl_off_t connectUs = 0, tlsUs = 0, firstByteUs = 0, totalUs = 0;
+    curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connectUs);
+    curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &tlsUs);
+    curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME_T, &firstByteUs);
+    curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &totalUs);
+    result.timing.connectedUs = connectUs > 0 ? qint64(connectUs) : -1;
+    result.timing.secureUs = tlsUs > 0 ? qint64(tlsUs) : -1;
+    result.timing.firstByteUs = firstByteUs > 0 ? qint64(firstByteUs) : -1;
+    result.timing.endUs = qint64(totalUs);
+
+    // Return the session only if nothing rebound it meanwhile and no other
+    // request already parked a session in the slot.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (generation == m_generation && !m_idle)
+            m_idle = std::move(session);
+    }
+    return result;
+}
+
+std::shared_ptr<cpr::Session> HttpSession::makeSession() {
+    auto session = std::make_shared<cpr::Session>();
+    CURL *handle = session->GetCurlHolder()->handle;
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, 60L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, 30L);
+    return session;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Trace.h"
+#include <cpr/cpr.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// Keep-alive HTTP connection owned by a backend. The curl handle (and with it
+// the DNS cache, TCP connection and TLS session) is kept warm between
+// captures and only rebuilt when the origin or credential changes.
+class HttpSession {
+public:
+    // Receives body bytes as they arrive. Only called for HTTP 200 responses;
+    // error bodies are collected into Result::response.text instead.
+    using DataCallback = std::function<void(std::string_view chunk)>;
+
+    struct Result {
+        cpr::Response response;
+        bool aborted = false;
+        Trace::RequestTiming timing;
+    };
+
+    // Drops the warm connection if origin or credential differ from the
+    // current binding; otherwise a no-op.
+    void rebind(const std::string &origin, const std::string &credential);
+
+    // Setting *abortFlag from another thread stops the transfer at curl's
+    // next progress or write callback.
+    Result post(const std::string &url, const cpr::Header &header,
+                std::string body, int timeoutMs,
+                const DataCallback &onData = DataCallback(),
+                const std::atomic<bool> *abortFlag = nullptr);
+
+private:
+    static std::shared_ptr<cpr::Session> makeSession();
+
+    std::mutex m_mutex;
+    std::shared_ptr<cpr::Session> m_idle;
+    std::string m_origin;
+    std::string m_credential;
+    std::uint64_t m_generation = 0;
+};
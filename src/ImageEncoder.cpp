@@ -0,0 +1,76 @@
+#include "ImageEncoder.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QImageWriter>
+
+static const char *formatName(EncoderSettings::Format format) {
+    switch (format) {
+        case EncoderSettings::Format::Png:
+        case EncoderSettings::Format::PalettePng: return "png";
+        case EncoderSettings::Format::Jpeg: return "jpeg";
+        case EncoderSettings::Format::WebP: return "webp";
+    }
+    return "png";
+}
+
+static const char *mimeTypeOf(EncoderSettings::Format format) {
+    switch (format) {
+        case EncoderSettings::Format::Png:
+        case EncoderSettings::Format::PalettePng: return "image/png";
+        case EncoderSettings::Format::Jpeg: return "image/jpeg";
+        case EncoderSettings::Format::WebP: return "image/webp";
+    }
+    return "image/png";
+}
+
+bool isEncoderAvailable(EncoderSettings::Format format) {
+    // Plugins are only discovered at startup
+    static const QList<QByteArray> formats = QImageWriter::supportedImageFormats();
+    return formats.contains(formatName(format));
+}
+
+static bool writeImage(const QImage &image, EncoderSettings::Format format, int quality,
+                       QByteArray *data) {
+    QImage source = image;
+    if (format == EncoderSettings::Format::PalettePng && source.format() != QImage::Format_Grayscale8
+        && source.format() != QImage::Format_Indexed8)
+        source = source.convertToFormat(QImage::Format_Indexed8, Qt::ThresholdDither | Qt::AutoColor);
+    else if (format == EncoderSettings::Format::Jpeg && source.hasAlphaChannel())
+        source = source.convertToFormat(QImage::Format_RGB32);
+
+    data->clear();
+    QBuffer buffer(data);
+    buffer.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buffer, formatName(format));
+    writer.setQuality(quality);
+    if (writer.write(source))
+        return true;
+    qWarning("Encoder: %s failed: %s", formatName(format), qPrintable(writer.errorString()));
+    return false;
+}
+
+EncodedImage encodeImage(const QImage &image, const EncoderSettings &settings) {
+    QElapsedTimer timer;
+    timer.start();
+
+    // Settings::encoderSettings() already swaps out a missing format
+    EncoderSettings::Format format = settings.format;
+    if (!isEncoderAvailable(format))
+        format = EncoderSettings::Format::Png;
+
+    EncodedImage encoded;
+    if (!writeImage(image, format, settings.quality, &encoded.data)) {
+        bool retried = false;
+        if (format != EncoderSettings::Format::Png) {
+            format = EncoderSettings::Format::Png;
+            retried = writeImage(image, format, -1, &encoded.data);
+        }
+        if (!retried)
+            encoded.data.clear();
+    }
+
+    encoded.mimeType = mimeTypeOf(format);
+    encoded.encodeMs = timer.nsecsElapsed() / 1e6;
+    return encoded;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+
+struct EncodedImage {
+    QByteArray data;
+    QByteArray mimeType;
+    double encodeMs = 0;
+};
+
+// How a capture is compressed for upload. Quality follows Qt's convention:
+// 0-100 for JPEG/WebP, and for PNG 0 is smallest/slowest, 100 is stored
+// uncompressed. -1 uses the format's default.
+struct EncoderSettings {
+    enum class Format {
+        Png,
+        PalettePng, // 8-bit indexed; suits flat-colour UI text
+        Jpeg,
+        WebP
+    };
+
+    Format format = Format::Png;
+    int quality = -1;
+};
+
+bool isEncoderAvailable(EncoderSettings::Format format);
+
+// Falls back to PNG when the requested format has no image plugin or fails
+// to write; empty data if even that fails
+EncodedImage encodeImage(const QImage &image, const EncoderSettings &settings);
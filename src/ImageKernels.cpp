@@ -0,0 +1,168 @@
+#include "ImageKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSIT_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace ImageKernels {
+
+static inline uchar lumaOf(quint32 p) {
+    quint32 r = (p >> 16) & 0xff;
+    quint32 g = (p >> 8) & 0xff;
+    quint32 b = p & 0xff;
+    return uchar((r * 77 + g * 150 + b * 29) >> 8);
+}
+
+void argbToLuma(const quint32 *src, uchar *dst, int count) {
+    int i = 0;
+#ifdef TRANSIT_HAVE_SSE2
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128i wr = _mm_set1_epi16(77);
+    const __m128i wg = _mm_set1_epi16(150);
+    const __m128i wb = _mm_set1_epi16(29);
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 4));
+
+        // Channels as eight 16-bit lanes; products wrap but the weighted sum
+        // stays below 2^16, so an unsigned shift recovers the exact result.
+        __m128i r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), mask),
+                                    _mm_and_si128(_mm_srli_epi32(hi, 16), mask));
+        __m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 8), mask),
+                                    _mm_and_si128(_mm_srli_epi32(hi, 8), mask));
+        __m128i b = _mm_packs_epi32(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+
+        __m128i y = _mm_add_epi16(_mm_mullo_epi16(r, wr), _mm_mullo_epi16(g, wg));
+        y = _mm_srli_epi16(_mm_add_epi16(y, _mm_mullo_epi16(b, wb)), 8);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(y, y));
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] = lumaOf(src[i]);
+}
+
+quint32 sumBytes(const uchar *src, int count) {
+    quint32 sum = 0;
+    int i = 0;
+#ifdef TRANSIT_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+    }
+    sum = quint32(_mm_cvtsi128_si32(acc)) + quint32(_mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#endif
+    for (; i < count; ++i)
+        sum += src[i];
+    return sum;
+}
+
+quint32 absDiffBytes(const uchar *a, const uchar *b, int count) {
+    quint32 sum = 0;
+    int i = 0;
+#ifdef TRANSIT_HAVE_SSE2
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    sum = quint32(_mm_cvtsi128_si32(acc)) + quint32(_mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#endif
+    for (; i < count; ++i)
+        sum += quint32(a[i] > b[i] ? a[i] - b[i] : b[i] - a[i]);
+    return sum;
+}
+
+void halveLuma(const uchar *row0, const uchar *row1, uchar *dst, int dstWidth) {
+    int i = 0;
+#ifdef TRANSIT_HAVE_SSE2
+    const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+    const __m128i two = _mm_set1_epi16(2);
+    for (; i + 8 <= dstWidth; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 2 * i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 2 * i));
+        // Even and odd columns of both rows as 16-bit lanes
+        __m128i sum = _mm_add_epi16(_mm_and_si128(a, lowBytes), _mm_srli_epi16(a, 8));
+        sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_and_si128(b, lowBytes), _mm_srli_epi16(b, 8)));
+        sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(sum, sum));
+    }
+#endif
+    for (; i < dstWidth; ++i)
+        dst[i] = uchar((row0[2 * i] + row0[2 * i + 1] + row1[2 * i] + row1[2 * i + 1] + 2) >> 2);
+}
+
+void halveArgb(const quint32 *row0, const quint32 *row1, quint32 *dst, int dstWidth) {
+    int i = 0;
+#ifdef TRANSIT_HAVE_SSE2
+    for (; i + 4 <= dstWidth; i += 4) {
+        __m128i v0 = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 2 * i)),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 2 * i)));
+        __m128i v1 = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 2 * i + 4)),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 2 * i + 4)));
+        // Split into even and odd pixels and average the pairs
+        __m128 f0 = _mm_castsi128_ps(v0);
+        __m128 f1 = _mm_castsi128_ps(v1);
+        __m128i even = _mm_castps_si128(_mm_shuffle_ps(f0, f1, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i odd = _mm_castps_si128(_mm_shuffle_ps(f0, f1, _MM_SHUFFLE(3, 1, 3, 1)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_avg_epu8(even, odd));
+    }
+#endif
+    for (; i < dstWidth; ++i) {
+        quint32 out = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            quint32 sum = ((row0[2 * i] >> shift) & 0xff) + ((row0[2 * i + 1] >> shift) & 0xff)
+                        + ((row1[2 * i] >> shift) & 0xff) + ((row1[2 * i + 1] >> shift) & 0xff);
+            out |= ((sum + 2) >> 2) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+void stretchLuma(uchar *data, int count, uchar lo, uchar hi) {
+    if (hi <= lo)
+        return;
+
+    // (v - lo) * factor >> 8 never exceeds 16 bits once v is clamped to hi
+    const quint32 factor = (255u << 8) / quint32(hi - lo);
+    int i = 0;
+#ifdef TRANSIT_HAVE_SSE2
+    const __m128i vlo = _mm_set1_epi8(char(lo));
+    const __m128i vhi = _mm_set1_epi8(char(hi));
+    const __m128i vfactor = _mm_set1_epi16(short(factor));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        v = _mm_subs_epu8(_mm_min_epu8(v, vhi), vlo);
+        __m128i l = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), vfactor), 8);
+        __m128i h = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), vfactor), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), _mm_packus_epi16(l, h));
+    }
+#endif
+    for (; i < count; ++i) {
+        quint32 v = qBound<quint32>(lo, data[i], hi) - lo;
+        data[i] = uchar((v * factor) >> 8);
+    }
+}
+
+void thresholdLuma(uchar *data, int count, uchar threshold) {
+    int i = 0;
+#ifdef TRANSIT_HAVE_SSE2
+    // v > t  <=>  max(v, t + 1) == v, using unsigned byte compares
+    if (threshold < 255) {
+        const __m128i limit = _mm_set1_epi8(char(threshold + 1));
+        for (; i + 16 <= count; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            __m128i above = _mm_cmpeq_epi8(_mm_max_epu8(v, limit), v);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), above);
+        }
+    }
+#endif
+    for (; i < count; ++i)
+        data[i] = data[i] > threshold ? 255 : 0;
+}
+
+} // namespace ImageKernels
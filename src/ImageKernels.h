@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Per-row pixel kernels used by the capture pipeline. Each has an SSE2 path
+// on x86-64 (SSE2 is part of the baseline ISA there) and a scalar fallback.
+namespace ImageKernels {
+
+// 0xAARRGGBB pixels to 8-bit luma, Y = (77 R + 150 G + 29 B) >> 8
+void argbToLuma(const quint32 *src, uchar *dst, int count);
+
+// Sum of count bytes
+quint32 sumBytes(const uchar *src, int count);
+
+// Sum of absolute differences between two runs of count bytes
+quint32 absDiffBytes(const uchar *a, const uchar *b, int count);
+
+// 2x2 box downscale of two source rows into dstWidth output pixels. The
+// SSE2 ARGB path averages in two rounded steps and may differ by one.
+void halveLuma(const uchar *row0, const uchar *row1, uchar *dst, int dstWidth);
+void halveArgb(const quint32 *row0, const quint32 *row1, quint32 *dst, int dstWidth);
+
+// Linear stretch mapping [lo, hi] onto [0, 255], in place
+void stretchLuma(uchar *data, int count, uchar lo, uchar hi);
+
+// Values above threshold become 255, the rest 0, in place
+void thresholdLuma(uchar *data, int count, uchar threshold);
+
+} // namespace ImageKernels
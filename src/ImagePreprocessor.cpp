@@ -0,0 +1,129 @@
+#include "ImagePreprocessor.h"
+#include "ImageKernels.h"
+
+#include <array>
+
+static double scaleFor(const QImage &image, const PreprocessOptions &options) {
+    double scale = 1.0;
+    if (options.targetTextHeight > 0 && options.sourceTextHeight > 0)
+        scale = qMin(scale, options.targetTextHeight / options.sourceTextHeight);
+    int longEdge = qMax(image.width(), image.height());
+    if (options.maxLongEdge > 0 && longEdge > options.maxLongEdge)
+        scale = qMin(scale, double(options.maxLongEdge) / longEdge);
+    return scale;
+}
+
+static QImage toLuma(const QImage &image) {
+    QImage argb = image.convertToFormat(QImage::Format_RGB32);
+    QImage luma(argb.size(), QImage::Format_Grayscale8);
+    for (int y = 0; y < argb.height(); ++y) {
+        ImageKernels::argbToLuma(reinterpret_cast<const quint32 *>(argb.constScanLine(y)),
+                                 luma.scanLine(y), argb.width());
+    }
+    return luma;
+}
+
+static QImage halve(const QImage &image) {
+    const int w = image.width() / 2;
+    const int h = image.height() / 2;
+    QImage out(w, h, image.format());
+    for (int y = 0; y < h; ++y) {
+        if (image.format() == QImage::Format_Grayscale8) {
+            ImageKernels::halveLuma(image.constScanLine(2 * y), image.constScanLine(2 * y + 1),
+                                    out.scanLine(y), w);
+        } else {
+            ImageKernels::halveArgb(reinterpret_cast<const quint32 *>(image.constScanLine(2 * y)),
+                                    reinterpret_cast<const quint32 *>(image.constScanLine(2 * y + 1)),
+                                    reinterpret_cast<quint32 *>(out.scanLine(y)), w);
+        }
+    }
+    return out;
+}
+
+static std::array<quint32, 256> histogramOf(const QImage &luma) {
+    std::array<quint32, 256> hist{};
+    for (int y = 0; y < luma.height(); ++y) {
+        const uchar *line = luma.constScanLine(y);
+        for (int x = 0; x < luma.width(); ++x)
+            ++hist[line[x]];
+    }
+    return hist;
+}
+
+static void stretchContrast(QImage &luma) {
+    // Ignore the outer 1% on each side so a few stray pixels don't pin the range
+    const std::array<quint32, 256> hist = histogramOf(luma);
+    const quint64 total = quint64(luma.width()) * luma.height();
+    const quint64 clip = total / 100;
+
+    int lo = 0;
+    for (quint64 seen = 0; lo < 255 && (seen += hist[lo]) <= clip; ++lo) {}
+    int hi = 255;
+    for (quint64 seen = 0; hi > 0 && (seen += hist[hi]) <= clip; --hi) {}
+    if (hi <= lo)
+        return;
+
+    for (int y = 0; y < luma.height(); ++y)
+        ImageKernels::stretchLuma(luma.scanLine(y), luma.width(), uchar(lo), uchar(hi));
+}
+
+static void binarize(QImage &luma) {
+    // Otsu: the threshold maximizing between-class variance
+    const std::array<quint32, 256> hist = histogramOf(luma);
+    const double total = double(luma.width()) * luma.height();
+    double sumAll = 0;
+    for (int i = 0; i < 256; ++i)
+        sumAll += double(i) * hist[i];
+
+    double sumBelow = 0;
+    double weightBelow = 0;
+    double bestVariance = -1;
+    int threshold = 127;
+    for (int t = 0; t < 256; ++t) {
+        weightBelow += hist[t];
+        if (weightBelow == 0)
+            continue;
+        double weightAbove = total - weightBelow;
+        if (weightAbove == 0)
+            break;
+        sumBelow += double(t) * hist[t];
+        double meanBelow = sumBelow / weightBelow;
+        double meanAbove = (sumAll - sumBelow) / weightAbove;
+        double variance = weightBelow * weightAbove * (meanBelow - meanAbove) * (meanBelow - meanAbove);
+        if (variance > bestVariance) {
+            bestVariance = variance;
+            threshold = t;
+        }
+    }
+
+    for (int y = 0; y < luma.height(); ++y)
+        ImageKernels::thresholdLuma(luma.scanLine(y), luma.width(), uchar(threshold));
+}
+
+QImage preprocessCapture(const QImage &image, const PreprocessOptions &options) {
+    if (image.isNull() || options.isIdentity())
+        return image;
+
+    const bool gray = options.colorMode != PreprocessOptions::ColorMode::Color;
+    QImage out = gray ? toLuma(image) : image.convertToFormat(QImage::Format_RGB32);
+
+    // Power-of-two steps with the box kernel, then one smooth fractional step
+    double scale = scaleFor(out, options);
+    while (scale <= 0.5 && out.width() >= 2 && out.height() >= 2) {
+        out = halve(out);
+        scale *= 2.0;
+    }
+    if (scale < 0.95) {
+        out = out.scaled(qMax(1, qRound(out.width() * scale)), qMax(1, qRound(out.height() * scale)),
+                         Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        if (gray && out.format() != QImage::Format_Grayscale8)
+            out = out.convertToFormat(QImage::Format_Grayscale8);
+    }
+
+    switch (options.colorMode) {
+        case PreprocessOptions::ColorMode::Contrast: stretchContrast(out); break;
+        case PreprocessOptions::ColorMode::Binary: binarize(out); break;
+        default: break;
+    }
+    return out;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QImage>
+
+// Optional clean-up of a capture before it is encoded: HiDPI-aware
+// downscaling plus grayscale, contrast stretch or binarization. Bboxes in
+// the response are normalized, so they map back onto the original
+// selection regardless of the scale applied here.
+struct PreprocessOptions {
+    enum class ColorMode {
+        Color,
+        Grayscale,
+        Contrast,   // grayscale with a 1%-99% linear stretch
+        Binary      // Otsu threshold
+    };
+
+    int targetTextHeight = 0;      // pixels; 0 keeps the capture resolution
+    double sourceTextHeight = 0;   // estimated glyph height in captured pixels
+    int maxLongEdge = 0;           // 0 = unlimited
+    ColorMode colorMode = ColorMode::Color;
+
+    bool isIdentity() const {
+        return targetTextHeight <= 0 && maxLongEdge <= 0 && colorMode == ColorMode::Color;
+    }
+};
+
+QImage preprocessCapture(const QImage &image, const PreprocessOptions &options);
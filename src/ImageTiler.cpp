@@ -0,0 +1,130 @@
+#include "ImageTiler.h"
+
+#include <cmath>
+
+namespace ImageTiler {
+
+namespace {
+
+int axisCount(int length, int maxEdge, int overlap) {
+    if (length <= maxEdge)
+        return 1;
+    const int stride = qMax(1, maxEdge - overlap);
+    return int(std::ceil(double(length - overlap) / stride));
+}
+
+// Start offsets and length of evenly spread tiles along one axis
+QVector<int> axisStarts(int length, int maxEdge, int overlap, int *tileLength) {
+    if (length <= maxEdge) {
+        *tileLength = length;
+        return {0};
+    }
+
+    const int count = axisCount(length, maxEdge, overlap);
+    // Spread the slack so every overlap is about equal
+    *tileLength = qMin(maxEdge, int(std::ceil(double(length + (count - 1) * overlap) / count)));
+
+    QVector<int> starts;
+    for (int i = 0; i < count; ++i)
+        starts.append(int(std::lround(double(i) * (length - *tileLength) / (count - 1))));
+    return starts;
+}
+
+double area(const QRectF &rect) {
+    return rect.width() * rect.height();
+}
+
+QString comparable(const QString &text) {
+    return text.simplified().toCaseFolded();
+}
+
+// Same text found by two tiles: boxes mostly overlap and one text is the
+// other, or a cut-off piece of it
+bool isDuplicate(const TextBlock &a, const TextBlock &b) {
+    QRectF shared = a.bbox.intersected(b.bbox);
+    double smaller = qMin(area(a.bbox), area(b.bbox));
+    if (shared.isEmpty() || smaller <= 0 || area(shared) < 0.5 * smaller)
+        return false;
+
+    QString textA = comparable(a.text);
+    QString textB = comparable(b.text);
+    if (textA.isEmpty() || textB.isEmpty())
+        return textA == textB;
+    return textA.contains(textB) || textB.contains(textA);
+}
+
+} // namespace
+
+QVector<QRect> plan(const QSize &size, int maxEdge, int overlap) {
+    QVector<QRect> tiles;
+    if (size.isEmpty() || maxEdge <= 0)
+        return tiles;
+
+    int tileWidth = 0;
+    int tileHeight = 0;
+    const QVector<int> xs = axisStarts(size.width(), maxEdge, overlap, &tileWidth);
+    const QVector<int> ys = axisStarts(size.height(), maxEdge, overlap, &tileHeight);
+    for (int y : ys) {
+        for (int x : xs)
+            tiles.append(QRect(x, y, tileWidth, tileHeight));
+    }
+    return tiles;
+}
+
+double fitScale(const QSize &size, int maxEdge, int overlap, int maxTiles) {
+    double scale = 1.0;
+    while (scale > 0.05) {
+        QSize scaled = size * scale;
+        if (axisCount(scaled.width(), maxEdge, overlap)
+            * axisCount(scaled.height(), maxEdge, overlap) <= maxTiles)
+            break;
+        scale *= 0.9;
+    }
+    return scale;
+}
+
+QRectF normalizedArea(const QRect &tile, const QSize &size) {
+    return QRectF(double(tile.x()) / size.width(), double(tile.y()) / size.height(),
+                  double(tile.width()) / size.width(), double(tile.height()) / size.height());
+}
+
+QVector<TextBlock> mapBlocks(const QVector<TextBlock> &blocks, const QRectF &area) {
+    QVector<TextBlock> mapped;
+    mapped.reserve(blocks.size());
+    for (TextBlock block : blocks) {
+        const QRectF box = block.bbox;
+        block.bbox = QRectF(area.x() + box.x() * area.width(),
+                            area.y() + box.y() * area.height(),
+                            box.width() * area.width(),
+                            box.height() * area.height());
+        mapped.append(block);
+    }
+    return mapped;
+}
+
+QVector<TextBlock> merge(const QVector<QVector<TextBlock>> &tiles) {
+    QVector<TextBlock> merged;
+    QVector<int> origin; // tile of each merged block
+
+    for (int tile = 0; tile < tiles.size(); ++tile) {
+        for (const TextBlock &block : tiles[tile]) {
+            int duplicate = -1;
+            for (int i = 0; i < merged.size() && duplicate < 0; ++i) {
+                // Blocks of one tile are never copies of each other
+                if (origin[i] != tile && isDuplicate(merged[i], block))
+                    duplicate = i;
+            }
+
+            if (duplicate < 0) {
+                merged.append(block);
+                origin.append(tile);
+            } else if (area(block.bbox) > area(merged[duplicate].bbox)) {
+                merged[duplicate] = block;
+                origin[duplicate] = tile;
+            }
+        }
+    }
+    return merged;
+}
+
+} // namespace ImageTiler
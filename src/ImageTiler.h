@@ -0,0 +1,32 @@
+#pragma once
+
+#include "AIService.h"
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+#include <QVector>
+
+// Splitting of large captures into overlapping tiles that are translated
+// separately, and merging of their results back into one block list.
+namespace ImageTiler {
+
+// Tiles of at most maxEdge pixels a side covering an image of the given
+// size, neighbours sharing at least overlap pixels. A single tile when the
+// image already fits. Row-major order.
+QVector<QRect> plan(const QSize &size, int maxEdge, int overlap);
+
+// Largest scale (at most 1) at which plan() needs no more than maxTiles
+double fitScale(const QSize &size, int maxEdge, int overlap, int maxTiles);
+
+// A tile's rectangle in normalized whole-image coordinates
+QRectF normalizedArea(const QRect &tile, const QSize &size);
+
+// Tile-normalized bboxes into whole-image normalized coordinates
+QVector<TextBlock> mapBlocks(const QVector<TextBlock> &blocks, const QRectF &area);
+
+// Concatenates the mapped blocks of each tile, dropping the second copy of
+// text read twice in an overlap zone. Of two copies the larger box is kept,
+// since a line cut by a tile edge comes back shorter.
+QVector<TextBlock> merge(const QVector<QVector<TextBlock>> &tiles);
+
+} // namespace ImageTiler
@@ -0,0 +1,63 @@
+#include "LatencyHistogram.h"
+
+#include <cmath>
+
+int LatencyHistogram::bucketOf(quint64 ms) {
+    if (ms < quint64(EXACT))
+        return int(ms);
+
+    // The top six bits select the bucket: bit 5 is always set, the five
+    // below it pick one of SUB_BUCKETS within the power of two
+    int magnitude = 0;
+    for (quint64 v = ms; v > 1; v >>= 1)
+        ++magnitude;
+    const int shift = magnitude - 5;
+    return EXACT + (shift - 1) * SUB_BUCKETS + int(ms >> shift) - SUB_BUCKETS;
+}
+
+double LatencyHistogram::valueOf(int bucket) {
+    if (bucket < EXACT)
+        return bucket;
+
+    // Middle of the bucket's range
+    const int shift = (bucket - EXACT) / SUB_BUCKETS + 1;
+    const quint64 low = quint64((bucket - EXACT) % SUB_BUCKETS + SUB_BUCKETS) << shift;
+    return double(low) + double((quint64(1) << shift) - 1) / 2;
+}
+
+void LatencyHistogram::record(double ms) {
+    const quint64 limit = (quint64(1) << (MAX_MAGNITUDE + 1)) - 1;
+    const quint64 value = quint64(qBound(0.0, std::round(ms), double(limit)));
+    ++m_buckets[bucketOf(value)];
+    ++m_count;
+    m_max = qMax(m_max, ms);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (int i = 0; i < BUCKETS; ++i)
+        m_buckets[i] += other.m_buckets[i];
+    m_count += other.m_count;
+    m_max = qMax(m_max, other.m_max);
+}
+
+void LatencyHistogram::reset() {
+    m_buckets.fill(0);
+    m_count = 0;
+    m_max = 0;
+}
+
+double LatencyHistogram::percentile(double p) const {
+    if (m_count == 0)
+        return 0;
+
+    // Smallest value with at least p% of the samples at or below it
+    const quint64 rank = qMax<quint64>(1, quint64(std::ceil(qBound(0.0, p, 100.0) / 100.0
+                                                            * double(m_count))));
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank)
+            return qMin(valueOf(i), m_max);
+    }
+    return m_max;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QtGlobal>
+#include <array>
+
+// Log-linear latency histogram in the style of HdrHistogram. Values below
+// 64 ms are counted exactly; above that each power of two is split into 32
+// linear buckets, so any percentile is reported within about 3% of a
+// recorded value at any magnitude, in a fixed 4.5 KB.
+class LatencyHistogram {
+public:
+    void record(double ms);
+    void merge(const LatencyHistogram &other);
+    void reset();
+
+    quint64 count() const { return m_count; }
+    // p in [0, 100]; 0 when empty
+    double percentile(double p) const;
+    double max() const { return m_max; }
+
+    // Values are clamped below 2^(MAX_MAGNITUDE + 1) ms, about 70 minutes
+    static constexpr int MAX_MAGNITUDE = 21;
+
+private:
+    static constexpr int EXACT = 64;
+    static constexpr int SUB_BUCKETS = 32;
+    static constexpr int BUCKETS = EXACT + (MAX_MAGNITUDE - 6 + 1) * SUB_BUCKETS;
+
+    static int bucketOf(quint64 ms);
+    static double valueOf(int bucket);
+
+    std::array<quint64, BUCKETS> m_buckets{};
+    quint64 m_count = 0;
+    double m_max = 0;
+};
@@ -0,0 +1,86 @@
+#include "LiveRegion.h"
+
+#include <QPainter>
+
+#include <cmath>
+
+LiveRegion::LiveRegion(QObject *parent)
+    : QObject(parent) {
+    connect(&m_timer, &QTimer::timeout, this, &LiveRegion::tick);
+}
+
+void LiveRegion::start(const QRect &region, int intervalMs) {
+    m_region = region;
+    m_diff.reset();
+    m_frame = QImage();
+    m_dirty = QRect();
+    m_sent = QRect();
+    m_busy = false;
+    m_timer.start(intervalMs);
+    tick();
+}
+
+void LiveRegion::stop() {
+    m_timer.stop();
+    m_excluded = QRect();
+    m_diff.reset();
+    m_frame = QImage();
+    m_busy = false;
+}
+
+void LiveRegion::captureFinished(bool ok) {
+    if (!m_busy)
+        return;
+    m_busy = false;
+    if (!ok)
+        m_dirty |= m_sent;
+    m_sent = QRect();
+}
+
+void LiveRegion::tick() {
+    RegionGrab grab = RegionSelector::grabScreens(m_region);
+    if (grab.pieces.isEmpty())
+        return;
+    m_frame = grab.stitch(m_region.size());
+    const QRect excluded = m_excluded & m_region;
+    if (!excluded.isEmpty()) {
+        QPainter painter(&m_frame);
+        painter.fillRect(excluded.translated(-m_region.topLeft()), Qt::black);
+    }
+    m_dirty |= m_diff.update(m_frame);
+
+    if (m_busy && m_busyClock.elapsed() < BUSY_TIMEOUT_MS)
+        return;
+    if (m_busy) {
+        qWarning("Live region: capture never finished, resending");
+        m_dirty |= m_sent;
+    }
+    if (m_dirty.isNull())
+        return;
+
+    // Text runs sideways, so a change anywhere in a line resends the whole
+    // line: the band spans the full width, padded by a tile above and below
+    QRect band(0, m_dirty.top() - FrameDiff::TILE, m_frame.width(),
+               m_dirty.height() + 2 * FrameDiff::TILE);
+    band &= m_frame.rect();
+    if (band.height() > WHOLE_REGION_SHARE * m_frame.height())
+        band = m_frame.rect();
+
+    const qreal dpr = m_frame.devicePixelRatio();
+    const int top = int(std::floor(band.top() / dpr));
+    const int bottom = qMin(m_region.height(), int(std::ceil((band.bottom() + 1) / dpr)));
+    const QRect area(m_region.x(), m_region.y() + top, m_region.width(), bottom - top);
+
+    QImage crop = m_frame.copy(0, int(std::lround(top * dpr)), m_frame.width(),
+                               int(std::lround((bottom - top) * dpr)));
+    crop.setDevicePixelRatio(dpr);
+    RegionGrab changedGrab;
+    changedGrab.pieces.append(RegionGrab::Piece{QPoint(0, 0), crop});
+    changedGrab.grabMs = grab.grabMs;
+
+    m_sent = band;
+    m_dirty = QRect();
+    m_busy = true;
+    m_busyClock.start();
+    emit changed(area, changedGrab);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "FrameDiff.h"
+#include "RegionSelector.h"
+#include <QElapsedTimer>
+#include <QObject>
+#include <QRect>
+#include <QTimer>
+
+// A pinned screen rectangle that is re-grabbed on a timer. Each frame is
+// diffed against the last one, and only the rows that changed are handed
+// on, one capture at a time: changes seen while a capture is in flight
+// accumulate and go out together once captureFinished() is called.
+class LiveRegion : public QObject {
+    Q_OBJECT
+public:
+    explicit LiveRegion(QObject *parent = nullptr);
+
+    void start(const QRect &region, int intervalMs);
+    void stop();
+    // A screen area to leave out of every frame, such as a result overlay
+    // that could not be placed beside the region; blacked out before the
+    // diff so its own text never counts as a change. Kept until stop().
+    void setExcluded(const QRect &screenRect) { m_excluded = screenRect; }
+    void setInterval(int intervalMs) { m_timer.setInterval(intervalMs); }
+    bool isActive() const { return m_timer.isActive(); }
+    QRect region() const { return m_region; }
+
+    // The capture from the last changed() is done; a failed one is resent
+    void captureFinished(bool ok);
+
+signals:
+    // area is the changed part of region() in logical screen coordinates;
+    // grab holds just that part
+    void changed(const QRect &area, const RegionGrab &grab);
+
+private:
+    void tick();
+
+    QTimer m_timer;
+    FrameDiff m_diff;
+    QRect m_region;
+    QRect m_excluded; // logical screen coordinates
+    QImage m_frame;   // latest grab
+    QRect m_dirty;    // device pixels, not yet sent
+    QRect m_sent;     // device pixels, in flight
+    bool m_busy = false;
+    QElapsedTimer m_busyClock;
+
+    // A capture that never reports back stops blocking after this long
+    static constexpr qint64 BUSY_TIMEOUT_MS = 60000;
+    // Past this share of the height the whole region is sent
+    static constexpr double WHOLE_REGION_SHARE = 0.7;
+};
@@ -0,0 +1,95 @@
+#include "LocalOcr.h"
+
+#ifdef TRANSIT_WITH_TESSERACT
+#include <tesseract/baseapi.h>
+#include <tesseract/resultiterator.h>
+
+// Lines Tesseract is less sure of than this are mostly noise from icons
+// and UI chrome
+static constexpr float MIN_LINE_CONFIDENCE = 40.0f;
+
+struct LocalOcr::Engine {
+    tesseract::TessBaseAPI api;
+};
+#else
+struct LocalOcr::Engine {};
+#endif
+
+LocalOcr::LocalOcr() = default;
+
+LocalOcr::~LocalOcr() {
+#ifdef TRANSIT_WITH_TESSERACT
+    if (m_engine)
+        m_engine->api.End();
+#endif
+}
+
+bool LocalOcr::isAvailable() {
+#ifdef TRANSIT_WITH_TESSERACT
+    return true;
+#else
+    return false;
+#endif
+}
+
+QVector<TextBlock> LocalOcr::recognize(const QImage &image, const QString &languages,
+                                       QString *error) {
+    QVector<TextBlock> lines;
+#ifdef TRANSIT_WITH_TESSERACT
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Loading trained data takes a while, so the engine is kept between
+    // captures and only re-initialised when the languages change
+    if (!m_engine || languages != m_languages) {
+        if (m_engine)
+            m_engine->api.End();
+        m_engine = std::make_unique<Engine>();
+        if (m_engine->api.Init(nullptr, languages.toUtf8().constData()) != 0) {
+            m_engine.reset();
+            if (error)
+                *error = QString("Tesseract has no trained data for \"%1\"").arg(languages);
+            return lines;
+        }
+        m_engine->api.SetPageSegMode(tesseract::PSM_AUTO);
+        m_languages = languages;
+    }
+
+    QImage gray = image.convertToFormat(QImage::Format_Grayscale8);
+    tesseract::TessBaseAPI &api = m_engine->api;
+    api.SetImage(gray.constBits(), gray.width(), gray.height(), 1, int(gray.bytesPerLine()));
+    api.SetSourceResolution(int(96 * image.devicePixelRatio()));
+    if (api.Recognize(nullptr) != 0) {
+        if (error)
+            *error = "Tesseract could not recognise the capture";
+        api.Clear();
+        return lines;
+    }
+
+    std::unique_ptr<tesseract::ResultIterator> it(api.GetIterator());
+    const auto level = tesseract::RIL_TEXTLINE;
+    if (it) {
+        do {
+            if (it->Confidence(level) < MIN_LINE_CONFIDENCE)
+                continue;
+            std::unique_ptr<char[]> text(it->GetUTF8Text(level));
+            QString line = text ? QString::fromUtf8(text.get()).simplified() : QString();
+            int x1, y1, x2, y2;
+            if (line.isEmpty() || !it->BoundingBox(level, &x1, &y1, &x2, &y2))
+                continue;
+
+            TextBlock block;
+            block.text = line;
+            block.bbox = QRectF(double(x1) / gray.width(), double(y1) / gray.height(),
+                                double(x2 - x1) / gray.width(), double(y2 - y1) / gray.height());
+            lines.append(block);
+        } while (it->Next(level));
+    }
+    api.Clear();
+#else
+    Q_UNUSED(image);
+    Q_UNUSED(languages);
+    if (error)
+        *error = "Built without local OCR support";
+#endif
+    return lines;
+}
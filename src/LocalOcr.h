@@ -0,0 +1,30 @@
+#pragma once
+
+#include "AIService.h"
+#include <QImage>
+#include <QString>
+#include <memory>
+#include <mutex>
+
+// Offline text recognition for the text-only translation path. Backed by
+// Tesseract when built with TRANSIT_WITH_TESSERACT; otherwise unavailable
+// and recognize() finds nothing.
+class LocalOcr {
+public:
+    LocalOcr();
+    ~LocalOcr();
+
+    static bool isAvailable();
+
+    // Text lines with normalized boxes. languages uses Tesseract's form,
+    // e.g. "eng+jpn". Safe to call from any thread; calls are serialized.
+    QVector<TextBlock> recognize(const QImage &image, const QString &languages,
+                                 QString *error = nullptr);
+
+private:
+    struct Engine;
+
+    std::unique_ptr<Engine> m_engine;
+    QString m_languages; // the engine was initialised for these
+    std::mutex m_mutex;
+};
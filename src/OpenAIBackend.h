@@ -1,9 +1,6 @@
 #pragma once
 
 #include "AIService.h"
-#include <QFuture>
-#include <QPointer>
-#include <atomic>
 
 class OpenAIBackend : public AIService {
     Q_OBJECT
@@ -13,14 +10,23 @@ public:
     ~OpenAIBackend() override;
 
     QString name() const override { return "OpenAI"; }
-    void translate(const QByteArray &pngImageData,
-                   const QString &targetLanguage) override;
-    void cancel() override;
+    void reconfigure(const QString &apiKey, const QString &baseUrl,
+                     const QString &modelName) override;
+    quint64 translate(const EncodedImage &image,
+                      const QString &targetLanguage,
+                      const RequestScheduler::Options &options = {}) override;
+    quint64 translateLines(const QVector<TextBlock> &lines,
+                           const QString &targetLanguage,
+                           const RequestScheduler::Options &options = {}) override;
+
+    // Body of the first request translate() sends; used by the benchmark
+    std::string visionBody(const EncodedImage &image, const QString &targetLanguage) const;
 
 private:
+    HttpRequest visionRequest(const EncodedImage &image, const QString &targetLanguage) const;
+    HttpRequest chatRequest() const;
+
     QString m_apiKey;
     QString m_baseUrl;
     QString m_modelName;
-    std::atomic_bool m_cancelled{false};
-    QFuture<void> m_future;
 };
@@ -1,4 +1,5 @@
 #include "OverlayWindow.h"
+#include "Trace.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -85,8 +86,8 @@ void OverlayWindow::setupUi() {
     connect(m_closeBtn, &QPushButton::clicked, this, &OverlayWindow::dismiss);
 }
 
-void OverlayWindow::showLoading(const QRect &selectionRect) {
-    m_selectionRect = selectionRect;
+void OverlayWindow::reset(const QRect &rect) {
+    m_selectionRect = rect;
     m_blocks.clear();
     m_plainText.clear();
     m_showBlocks = false;
@@ -94,15 +95,87 @@ void OverlayWindow::showLoading(const QRect &selectionRect) {
     m_errorText.clear();
 
     m_loadingLabel->show();
-    m_loadingLabel->setGeometry(0, 0, selectionRect.width(), selectionRect.height());
+    m_loadingLabel->setGeometry(0, 0, rect.width(), rect.height());
     m_buttonBar->hide();
 
-    setGeometry(selectionRect);
+    setGeometry(rect);
+}
+
+void OverlayWindow::showLoading(const QRect &selectionRect) {
+    m_liveRect = QRect();
+    reset(selectionRect);
+    setAttribute(Qt::WA_ShowWithoutActivating, false);
     show();
     activateWindow();
 }
 
+void OverlayWindow::showLive(const QRect &liveRect) {
+    QScreen *screen = QGuiApplication::screenAt(liveRect.center());
+    QRect available = screen ? screen->availableGeometry() : liveRect;
+
+    // Below, above, right, left at the region's size; failing that the
+    // roomiest strip left beside it, and over the region only as a last resort
+    const QRect candidates[] = {
+        liveRect.translated(0, liveRect.height()),
+        liveRect.translated(0, -liveRect.height()),
+        liveRect.translated(liveRect.width(), 0),
+        liveRect.translated(-liveRect.width(), 0),
+    };
+    QRect placed;
+    for (const QRect &candidate : candidates) {
+        if (available.contains(candidate)) {
+            placed = candidate;
+            break;
+        }
+    }
+    if (placed.isNull()) {
+        const QRect strips[] = {
+            QRect(QPoint(liveRect.left(), liveRect.bottom() + 1),
+                  QPoint(liveRect.right(), available.bottom())),
+            QRect(QPoint(liveRect.left(), available.top()),
+                  QPoint(liveRect.right(), liveRect.top() - 1)),
+            QRect(QPoint(liveRect.right() + 1, liveRect.top()),
+                  QPoint(available.right(), liveRect.bottom())),
+            QRect(QPoint(available.left(), liveRect.top()),
+                  QPoint(liveRect.left() - 1, liveRect.bottom())),
+        };
+        for (const QRect &strip : strips) {
+            const QRect usable = strip & available;
+            if (usable.width() >= MIN_LIVE_WIDTH && usable.height() >= MIN_LIVE_HEIGHT
+                && usable.width() * usable.height() > placed.width() * placed.height())
+                placed = usable;
+        }
+    }
+    if (placed.isNull())
+        placed = liveRect;
+
+    m_liveRect = liveRect;
+    reset(placed);
+    setAttribute(Qt::WA_ShowWithoutActivating, true);
+    show();
+}
+
+void OverlayWindow::appendBlocks(const QVector<TextBlock> &blocks) {
+    if (m_hasError || !isVisible())
+        return;
+
+    // Partial results are always drawn in place; showResult() decides the
+    // final layout once the complete list is known.
+    m_blocks += blocks;
+    m_showBlocks = true;
+    m_usePositionedLayout = true;
+    m_loadingLabel->hide();
+
+    update();
+}
+
+void OverlayWindow::traceNextResult(quint64 track, qint64 startUs) {
+    m_traceTrack = track;
+    m_traceStartUs = startUs;
+}
+
 void OverlayWindow::showResult(const QVector<TextBlock> &blocks) {
+    const qint64 layoutStartUs = Trace::now();
     m_blocks = blocks;
     m_showBlocks = true;
     m_hasError = false;
@@ -126,6 +199,10 @@ void OverlayWindow::showResult(const QVector<TextBlock> &blocks) {
         adjustSizeForFallback();
     }
 
+    if (m_traceTrack != 0) {
+        m_layoutEndUs = Trace::now();
+        Trace::record("layout", m_traceTrack, layoutStartUs, m_layoutEndUs);
+    }
     update();
 }
 
@@ -261,6 +338,11 @@ void OverlayWindow::adjustSizeForFallback() {
     QScreen *screen = QGuiApplication::screenAt(m_selectionRect.center());
     if (!screen) screen = QGuiApplication::primaryScreen();
     int maxHeight = screen->availableGeometry().bottom() - m_selectionRect.y();
+    // Growing down from above a live region would cover it
+    if (m_liveRect.isValid() && m_selectionRect.bottom() < m_liveRect.top()
+        && m_selectionRect.left() <= m_liveRect.right()
+        && m_selectionRect.right() >= m_liveRect.left())
+        maxHeight = qMin(maxHeight, m_liveRect.top() - m_selectionRect.y());
     newHeight = qMin(newHeight, maxHeight);
 
     setGeometry(m_selectionRect.x(), m_selectionRect.y(),
@@ -275,5 +357,15 @@ bool OverlayWindow::event(QEvent *event) {
         dismiss();
         return true;
     }
+    if (event->type() == QEvent::Paint && m_layoutEndUs >= 0) {
+        bool handled = QWidget::event(event);
+        const qint64 paintedUs = Trace::now();
+        Trace::record("first paint", m_traceTrack, m_layoutEndUs, paintedUs);
+        if (m_traceStartUs >= 0)
+            Trace::record("hotkey to overlay", m_traceTrack, m_traceStartUs, paintedUs);
+        m_traceTrack = 0;
+        m_layoutEndUs = -1;
+        return handled;
+    }
     return QWidget::event(event);
 }
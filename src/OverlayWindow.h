@@ -14,12 +14,23 @@ public:
     explicit OverlayWindow(QWidget *parent = nullptr);
 
     void showLoading(const QRect &selectionRect);
+    // For a live region: sits beside the region instead of over it, so it
+    // never ends up in the region's own grabs, and does not take focus.
+    // Only when the screen has no usable room beside the region does it
+    // cover the region; the caller then has to leave geometry() out of
+    // its grabs.
+    void showLive(const QRect &liveRect);
+    void appendBlocks(const QVector<TextBlock> &blocks);
     void showResult(const QVector<TextBlock> &blocks);
     void showError(const QString &error);
     void dismiss();
 
     void setFontSize(int size);
 
+    // Traces the layout and first paint of the next showResult() on the
+    // given track; with startUs set, also the whole span since then
+    void traceNextResult(quint64 track, qint64 startUs = -1);
+
 signals:
     void dismissed();
 
@@ -30,6 +41,7 @@ protected:
 
 private:
     void setupUi();
+    void reset(const QRect &rect);
     bool blocksOverflow() const;
     void adjustSizeForFallback();
 
@@ -40,6 +52,7 @@ private:
     QWidget *m_buttonBar = nullptr;
 
     QRect m_selectionRect;
+    QRect m_liveRect; // the live region to keep clear of, if any
     QVector<TextBlock> m_blocks;
     QString m_plainText;
     int m_fontSize = 14;
@@ -48,7 +61,14 @@ private:
     bool m_hasError = false;
     QString m_errorText;
 
+    quint64 m_traceTrack = 0;
+    qint64 m_traceStartUs = -1;
+    qint64 m_layoutEndUs = -1; // set while the traced result awaits its paint
+
     static constexpr int PADDING = 12;
     static constexpr int BUTTON_BAR_HEIGHT = 36;
     static constexpr int MAX_FONT_PX = 48;
+    // Smallest strip beside a live region worth placing the overlay in
+    static constexpr int MIN_LIVE_WIDTH = 160;
+    static constexpr int MIN_LIVE_HEIGHT = 80;
 };
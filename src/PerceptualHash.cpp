@@ -0,0 +1,135 @@
+#include "PerceptualHash.h"
+#include "ImageKernels.h"
+
+#include <QtMath>
+
+static constexpr int GRID_W = 17;
+static constexpr int GRID_H = 16;
+
+ImageFingerprint computeFingerprint(const QImage &source) {
+    ImageFingerprint fp;
+    if (source.isNull())
+        return fp;
+
+    QImage image = source;
+    if (image.format() != QImage::Format_RGB32 && image.format() != QImage::Format_ARGB32
+        && image.format() != QImage::Format_ARGB32_Premultiplied)
+        image = image.convertToFormat(QImage::Format_RGB32);
+    if (image.width() < GRID_W || image.height() < GRID_H)
+        image = image.scaled(qMax(image.width(), GRID_W), qMax(image.height(), GRID_H));
+
+    const int w = image.width();
+    const int h = image.height();
+
+    int colEdge[GRID_W + 1];
+    for (int c = 0; c <= GRID_W; ++c)
+        colEdge[c] = c * w / GRID_W;
+
+    // Area-average luma onto the grid, one SIMD luma pass per scanline
+    quint64 sums[GRID_H][GRID_W] = {};
+    int rows[GRID_H] = {};
+    std::vector<uchar> luma(w);
+    for (int y = 0; y < h; ++y) {
+        const int gy = y * GRID_H / h;
+        ImageKernels::argbToLuma(reinterpret_cast<const quint32 *>(image.constScanLine(y)),
+                                 luma.data(), w);
+        for (int c = 0; c < GRID_W; ++c)
+            sums[gy][c] += ImageKernels::sumBytes(luma.data() + colEdge[c], colEdge[c + 1] - colEdge[c]);
+        ++rows[gy];
+    }
+
+    int bit = 0;
+    for (int gy = 0; gy < GRID_H; ++gy) {
+        quint64 prev = sums[gy][0] / quint64(rows[gy] * (colEdge[1] - colEdge[0]));
+        for (int c = 1; c < GRID_W; ++c, ++bit) {
+            quint64 cur = sums[gy][c] / quint64(rows[gy] * (colEdge[c + 1] - colEdge[c]));
+            if (prev < cur)
+                fp.bits[bit / 64] |= quint64(1) << (bit % 64);
+            prev = cur;
+        }
+    }
+
+    fp.width = source.width();
+    fp.height = source.height();
+    return fp;
+}
+
+int hammingDistance(const ImageFingerprint &a, const ImageFingerprint &b) {
+    int distance = 0;
+    for (size_t i = 0; i < a.bits.size(); ++i)
+        distance += qPopulationCount(a.bits[i] ^ b.bits[i]);
+    return distance;
+}
+
+static bool similarSize(const ImageFingerprint &a, const ImageFingerprint &b) {
+    return qAbs(a.width - b.width) <= qMax(4, a.width / 50)
+        && qAbs(a.height - b.height) <= qMax(4, a.height / 50);
+}
+
+void PerceptualIndex::insert(const ImageFingerprint &fingerprint, const QByteArray &value) {
+    if (m_nodes.empty()) {
+        m_nodes.push_back({fingerprint, value, {}});
+        return;
+    }
+
+    int index = 0;
+    for (;;) {
+        Node &node = m_nodes[index];
+        int d = hammingDistance(fingerprint, node.fingerprint);
+        if (d == 0 && similarSize(fingerprint, node.fingerprint)) {
+            node.fingerprint = fingerprint;
+            node.value = value;
+            return;
+        }
+
+        int next = -1;
+        for (const auto &child : node.children) {
+            if (child.first == d) {
+                next = child.second;
+                break;
+            }
+        }
+        if (next < 0) {
+            node.children.emplace_back(d, int(m_nodes.size()));
+            m_nodes.push_back({fingerprint, value, {}});
+            return;
+        }
+        index = next;
+    }
+}
+
+QByteArray PerceptualIndex::findNearest(const ImageFingerprint &fingerprint, int maxDistance) const {
+    QByteArray best;
+    int bestDistance = maxDistance + 1;
+    if (m_nodes.empty())
+        return best;
+
+    std::vector<int> pending{0};
+    while (!pending.empty()) {
+        const Node &node = m_nodes[pending.back()];
+        pending.pop_back();
+
+        int d = hammingDistance(fingerprint, node.fingerprint);
+        if (d < bestDistance && similarSize(fingerprint, node.fingerprint)) {
+            best = node.value;
+            bestDistance = d;
+        }
+
+        // Triangle inequality: only subtrees within the radius can match
+        for (const auto &child : node.children) {
+            if (qAbs(child.first - d) <= maxDistance)
+                pending.push_back(child.second);
+        }
+    }
+    return best;
+}
+
+void PerceptualIndex::shrinkTo(int maxEntries) {
+    if (size() <= maxEntries)
+        return;
+
+    std::vector<Node> old;
+    old.swap(m_nodes);
+    for (size_t i = old.size() / 2; i < old.size(); ++i)
+        insert(old[i].fingerprint, old[i].value);
+}
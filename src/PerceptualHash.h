@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <array>
+#include <utility>
+#include <vector>
+
+// 256-bit difference hash (dHash) of a capture: luma is area-averaged onto a
+// 17x16 grid and each bit records whether a cell is darker than its right
+// neighbour. Captures that differ by a pixel of selection or a blinking
+// caret land within a few bits of each other.
+struct ImageFingerprint {
+    std::array<quint64, 4> bits{};
+    int width = 0;
+    int height = 0;
+
+    bool isNull() const { return width == 0; }
+};
+
+ImageFingerprint computeFingerprint(const QImage &image);
+int hammingDistance(const ImageFingerprint &a, const ImageFingerprint &b);
+
+// BK-tree over Hamming distance mapping fingerprints to opaque values.
+// Only entries whose capture size is within a small tolerance match.
+class PerceptualIndex {
+public:
+    void insert(const ImageFingerprint &fingerprint, const QByteArray &value);
+    QByteArray findNearest(const ImageFingerprint &fingerprint, int maxDistance) const;
+
+    int size() const { return int(m_nodes.size()); }
+    void clear() { m_nodes.clear(); }
+
+    // Keeps the newest half once the index grows past maxEntries
+    void shrinkTo(int maxEntries);
+
+private:
+    struct Node {
+        ImageFingerprint fingerprint;
+        QByteArray value;
+        std::vector<std::pair<int, int>> children; // (distance, node index)
+    };
+
+    std::vector<Node> m_nodes;
+};
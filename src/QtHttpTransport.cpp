@@ -0,0 +1,124 @@
+#include "QtHttpTransport.h"
+
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QTimer>
+#include <QUrl>
+#include <memory>
+
+// Qt maps 4xx replies to the content errors and 5xx to the server errors
+static bool isHttpStatusError(QNetworkReply::NetworkError error) {
+    return (error >= QNetworkReply::ContentAccessDenied
+            && error <= QNetworkReply::UnknownContentError)
+           || (error >= QNetworkReply::InternalServerError
+               && error <= QNetworkReply::UnknownServerError);
+}
+
+QtHttpTransport::QtHttpTransport(QObject *parent)
+    : QObject(parent), m_manager(new QNetworkAccessManager(this)) {}
+
+void QtHttpTransport::rebind(const std::string &origin, const std::string &credential) {
+    if (origin == m_origin && credential == m_credential)
+        return;
+
+    m_origin = origin;
+    m_credential = credential;
+    m_manager->clearConnectionCache();
+}
+
+void QtHttpTransport::post(const std::string &url, const Headers &headers, std::string body,
+                           int timeoutMs, DataCallback onData, FinishedCallback onFinished,
+                           const RequestScheduler::AbortFlag &aborted) {
+    QNetworkRequest request(QUrl(QString::fromStdString(url)));
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    for (const auto &[name, value] : headers)
+        request.setRawHeader(QByteArray::fromStdString(name), QByteArray::fromStdString(value));
+
+    auto timer = std::make_shared<QElapsedTimer>();
+    timer->start();
+    QNetworkReply *reply = m_manager->post(request, QByteArray::fromStdString(body));
+
+    // A deadline for the whole exchange, as curl's timeout is; Qt's own
+    // transfer timeout only notices a connection that has gone quiet
+    auto deadlineHit = std::make_shared<bool>(false);
+    if (timeoutMs > 0) {
+        auto *deadline = new QTimer(reply);
+        deadline->setSingleShot(true);
+        connect(deadline, &QTimer::timeout, reply, [reply, deadlineHit]() {
+            *deadlineHit = true;
+            reply->abort();
+        });
+        deadline->start(timeoutMs);
+    }
+
+    // Same contract as HttpSession: everything is collected, and only a
+    // successful body is streamed to onData
+    auto received = std::make_shared<std::string>();
+    auto consume = [reply, received, onData]() {
+        const QByteArray chunk = reply->readAll();
+        if (chunk.isEmpty())
+            return;
+        received->append(chunk.constData(), size_t(chunk.size()));
+        if (onData && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200)
+            onData(std::string_view(chunk.constData(), size_t(chunk.size())));
+    };
+    connect(reply, &QNetworkReply::readyRead, this, consume);
+
+    auto timing = std::make_shared<Trace::RequestTiming>();
+    connect(reply, &QNetworkReply::encrypted, this, [timer, timing]() {
+        timing->secureUs = timer->nsecsElapsed() / 1000;
+    });
+    connect(reply, &QNetworkReply::metaDataChanged, this, [timer, timing]() {
+        if (timing->firstByteUs < 0)
+            timing->firstByteUs = timer->nsecsElapsed() / 1000;
+    });
+
+    connect(reply, &QNetworkReply::finished, this,
+            [reply, received, consume, onFinished, timer, timing, aborted, deadlineHit,
+             timeoutMs]() {
+        consume();
+        timing->endUs = timer->nsecsElapsed() / 1000;
+
+        Result result;
+        result.statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        result.text = std::move(*received);
+        result.aborted = aborted && aborted->isAborted();
+        if (result.statusCode != 0) {
+            timing->protocol = reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool()
+                ? "h2" : "http/1.1";
+        }
+        result.timing = *timing;
+        // A transfer that fails after the headers still has a status code,
+        // so only the HTTP error statuses themselves are left to the caller
+        const QNetworkReply::NetworkError error = reply->error();
+        if (error != QNetworkReply::NoError
+            && (result.statusCode == 0 || !isHttpStatusError(error))) {
+            result.timedOut = !result.aborted
+                              && (*deadlineHit || error == QNetworkReply::TimeoutError);
+            // The deadline aborts the reply as if it had been cancelled
+            result.error = *deadlineHit && !result.aborted
+                ? QString("Operation timed out after %1 ms").arg(timeoutMs)
+                : reply->errorString();
+        }
+
+        reply->deleteLater();
+        onFinished(result);
+    });
+
+    if (aborted) {
+        // The abort may be raised on any thread; the reply is only touched here
+        QPointer<QtHttpTransport> self(this);
+        QPointer<QNetworkReply> guard(reply);
+        aborted->onAbort([self, guard]() {
+            if (!self)
+                return;
+            QMetaObject::invokeMethod(self.data(), [guard]() {
+                if (guard)
+                    guard->abort();
+            }, Qt::QueuedConnection);
+        });
+    }
+}
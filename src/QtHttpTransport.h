@@ -0,0 +1,52 @@
+#pragma once
+
+#include "RequestScheduler.h"
+#include "Trace.h"
+#include <QObject>
+#include <QString>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class QNetworkAccessManager;
+
+// Event-driven alternative to HttpSession on QNetworkAccessManager. Requests
+// are multiplexed over one HTTP/2 connection per origin where the server
+// supports it, without a blocking thread per request. Everything, including
+// the callbacks, runs on the thread that owns this object.
+class QtHttpTransport : public QObject {
+    Q_OBJECT
+public:
+    using Headers = std::vector<std::pair<std::string, std::string>>;
+    using DataCallback = std::function<void(std::string_view chunk)>;
+
+    struct Result {
+        int statusCode = 0;
+        std::string text;
+        QString error;  // transport-level failure, empty otherwise
+        bool aborted = false;
+        bool timedOut = false;
+        // Qt reports no separate connect, so secureUs covers it too
+        Trace::RequestTiming timing;
+    };
+    using FinishedCallback = std::function<void(const Result &result)>;
+
+    explicit QtHttpTransport(QObject *parent = nullptr);
+
+    // Drops pooled connections if origin or credential differ from the
+    // current binding; otherwise a no-op
+    void rebind(const std::string &origin, const std::string &credential);
+
+    // onData only sees the body of HTTP 200 responses, and timeoutMs bounds
+    // the whole exchange, as with HttpSession
+    void post(const std::string &url, const Headers &headers, std::string body,
+              int timeoutMs, DataCallback onData, FinishedCallback onFinished,
+              const RequestScheduler::AbortFlag &aborted = nullptr);
+
+private:
+    QNetworkAccessManager *m_manager = nullptr;
+    std::string m_origin;
+    std::string m_credential;
+};
@@ -5,6 +5,32 @@
 #include <QGuiApplication>
 #include <QMouseEvent>
 #include <QKeyEvent>
+#include <QElapsedTimer>
+#include <QRegion>
+
+QImage RegionGrab::stitch(const QSize &size) const {
+    // A selection on a single monitor is used as grabbed, at native resolution
+    if (pieces.size() == 1 && pieces[0].offset.isNull()
+        && pieces[0].image.deviceIndependentSize().toSize() == size)
+        return pieces[0].image;
+
+    // Otherwise composite at the highest pixel ratio involved so no monitor
+    // loses detail; uncovered areas stay black
+    qreal dpr = 1.0;
+    for (const auto &piece : pieces)
+        dpr = qMax(dpr, piece.image.devicePixelRatio());
+
+    QImage composite(size * dpr, QImage::Format_RGB32);
+    composite.setDevicePixelRatio(dpr);
+    composite.fill(Qt::black);
+
+    QPainter painter(&composite);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    for (const auto &piece : pieces)
+        painter.drawImage(piece.offset, piece.image);
+    painter.end();
+    return composite;
+}
 
 RegionSelector::RegionSelector(QWidget *parent)
     : QWidget(parent)
@@ -25,6 +51,9 @@ void RegionSelector::start() {
     m_startPos = QPoint();
     m_currentPos = QPoint();
 
+    // Before show(), so the overlay itself can never end up in the frame
+    freezeScreens();
+
     // Don't use showFullScreen() — it only fullscreens one monitor
     show();
     raise();
@@ -33,21 +62,46 @@ void RegionSelector::start() {
     grabKeyboard();
 }
 
+void RegionSelector::freezeScreens() {
+    // QScreen::grabWindow() and QPixmap belong to the GUI thread, so the
+    // screens are grabbed one after another, but only once per selection
+    m_frames.clear();
+
+    for (QScreen *screen : QGuiApplication::screens()) {
+        QPixmap pixmap = screen->grabWindow(0);
+        if (pixmap.isNull()) {
+            // Fall back to grabbing live on release
+            m_frames.clear();
+            break;
+        }
+        m_frames.append({screen->geometry(), pixmap});
+    }
+}
+
 void RegionSelector::paintEvent(QPaintEvent *) {
     QPainter painter(this);
 
-    painter.fillRect(rect(), QColor(0, 0, 0, 100));
-
-    if (m_selecting) {
-        // Convert global coordinates to widget-local for painting
-        QPoint localStart = mapFromGlobal(m_startPos);
-        QPoint localCurrent = mapFromGlobal(m_currentPos);
-        QRect selection = QRect(localStart, localCurrent).normalized();
+    // Convert global coordinates to widget-local for painting
+    QRect selection;
+    if (m_selecting)
+        selection = QRect(mapFromGlobal(m_startPos), mapFromGlobal(m_currentPos)).normalized();
 
+    if (m_frames.isEmpty()) {
+        painter.fillRect(rect(), QColor(0, 0, 0, 100));
         painter.setCompositionMode(QPainter::CompositionMode_Clear);
         painter.fillRect(selection, Qt::transparent);
-
         painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    } else {
+        for (const Frame &frame : m_frames) {
+            QRect target(mapFromGlobal(frame.geometry.topLeft()), frame.geometry.size());
+            painter.drawPixmap(target, frame.pixmap);
+        }
+        painter.setClipRegion(QRegion(rect()).subtracted(selection));
+        painter.fillRect(rect(), QColor(0, 0, 0, 100));
+        painter.setClipping(false);
+    }
+
+    if (m_selecting) {
         QPen pen(QColor(0, 120, 215), 2);
         painter.setPen(pen);
         painter.drawRect(selection);
@@ -72,38 +126,72 @@ void RegionSelector::mouseMoveEvent(QMouseEvent *event) {
 
 void RegionSelector::mouseReleaseEvent(QMouseEvent *event) {
     if (event->button() == Qt::LeftButton && m_selecting) {
-        m_selecting = false;
-        releaseMouse();
-        releaseKeyboard();
-        hide();
-
         QRect region = QRect(m_startPos, event->globalPosition().toPoint()).normalized();
 
         if (region.width() < 10 || region.height() < 10) {
+            finish();
             emit selectionCancelled();
             return;
         }
 
-        QPixmap screenshot = captureRegion(region);
-        emit regionSelected(region, screenshot);
+        if (m_frames.isEmpty()) {
+            finish();
+            emit regionSelected(region, grabScreens(region));
+            return;
+        }
+
+        RegionGrab grab = cropFrozen(region);
+        finish();
+        emit regionSelected(region, grab);
     }
 }
 
 void RegionSelector::keyPressEvent(QKeyEvent *event) {
     if (event->key() == Qt::Key_Escape) {
-        m_selecting = false;
-        releaseMouse();
-        releaseKeyboard();
-        hide();
+        finish();
         emit selectionCancelled();
     }
 }
 
-QPixmap RegionSelector::captureRegion(const QRect &region) {
-    // Composite capture from all screens that intersect the region
-    QPixmap composite(region.size());
-    composite.fill(Qt::black);
-    QPainter painter(&composite);
+void RegionSelector::finish() {
+    m_selecting = false;
+    releaseMouse();
+    releaseKeyboard();
+    hide();
+    m_frames.clear();
+}
+
+RegionGrab RegionSelector::cropFrozen(const QRect &region) const {
+    QElapsedTimer timer;
+    timer.start();
+    RegionGrab grab;
+
+    for (const Frame &frame : m_frames) {
+        QRect intersection = region.intersected(frame.geometry);
+        if (intersection.isEmpty())
+            continue;
+
+        // Frames are in device pixels; selections in logical ones
+        const qreal dpr = frame.pixmap.devicePixelRatio();
+        QRect source((intersection.topLeft() - frame.geometry.topLeft()) * dpr,
+                     intersection.size() * dpr);
+        QImage image = frame.pixmap.copy(source.intersected(frame.pixmap.rect())).toImage();
+        image.setDevicePixelRatio(dpr);
+
+        grab.pieces.append(RegionGrab::Piece{intersection.topLeft() - region.topLeft(), image});
+    }
+
+    grab.grabMs = timer.nsecsElapsed() / 1e6;
+    return grab;
+}
+
+RegionGrab RegionSelector::grabScreens(const QRect &region) {
+    // Live grab for platforms that refused the freeze, and for live regions.
+    // Screen grabs have to happen on the GUI thread; everything else waits
+    // for the capture pipeline
+    QElapsedTimer timer;
+    timer.start();
+    RegionGrab grab;
 
     for (QScreen *screen : QGuiApplication::screens()) {
         QRect screenGeo = screen->geometry();
@@ -117,12 +205,10 @@ QPixmap RegionSelector::captureRegion(const QRect &region) {
             intersection.width(),
             intersection.height());
 
-        painter.drawPixmap(
-            intersection.x() - region.x(),
-            intersection.y() - region.y(),
-            screenGrab);
+        grab.pieces.append(RegionGrab::Piece{intersection.topLeft() - region.topLeft(),
+                                              screenGrab.toImage()});
     }
 
-    painter.end();
-    return composite;
+    grab.grabMs = timer.nsecsElapsed() / 1e6;
+    return grab;
 }
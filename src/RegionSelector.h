@@ -1,10 +1,32 @@
 #pragma once
 
 #include <QWidget>
+#include <QImage>
 #include <QPixmap>
 #include <QRect>
 #include <QPoint>
+#include <QVector>
 
+// Screen pixels under a selection, one piece per monitor it spans. Pieces
+// keep their screen's device pixel ratio; stitching them together is left
+// to the capture pipeline so it happens off the GUI thread.
+struct RegionGrab {
+    struct Piece {
+        QPoint offset; // logical position inside the selection
+        QImage image;
+    };
+
+    QVector<Piece> pieces;
+    double grabMs = 0;
+
+    // The pieces as one image of the given logical size. Safe off the GUI
+    // thread.
+    QImage stitch(const QSize &size) const;
+};
+
+// Full-desktop selection overlay. start() freezes every screen before the
+// overlay appears; the selector paints that frame and the selection is cut
+// from it, so nothing is grabbed once the user lets go.
 class RegionSelector : public QWidget {
     Q_OBJECT
 public:
@@ -12,8 +34,11 @@ public:
 
     void start();
 
+    // Grabs the live screens under region; GUI thread only
+    static RegionGrab grabScreens(const QRect &region);
+
 signals:
-    void regionSelected(const QRect &region, const QPixmap &screenshot);
+    void regionSelected(const QRect &region, const RegionGrab &grab);
     void selectionCancelled();
 
 protected:
@@ -24,8 +49,16 @@ protected:
     void keyPressEvent(QKeyEvent *event) override;
 
 private:
-    QPixmap captureRegion(const QRect &region);
+    struct Frame {
+        QRect geometry; // logical screen geometry
+        QPixmap pixmap; // at the screen's device pixel ratio
+    };
+
+    void freezeScreens();
+    void finish();
+    RegionGrab cropFrozen(const QRect &region) const;
 
+    QVector<Frame> m_frames; // empty when the platform refused a grab
     QPoint m_startPos;
     QPoint m_currentPos;
     bool m_selecting = false;
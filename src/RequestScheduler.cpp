@@ -0,0 +1,275 @@
+#include "RequestScheduler.h"
+
+#include <QPointer>
+#include <QSet>
+
+void AbortSignal::onAbort(std::function<void()> callback) const {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_aborted.load()) {
+        lock.unlock();
+        callback();
+        return;
+    }
+    m_callback = std::move(callback);
+}
+
+void AbortSignal::trigger() {
+    std::function<void()> callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_aborted.exchange(true))
+            return;
+        callback = std::move(m_callback);
+    }
+    if (callback)
+        callback();
+}
+
+RequestScheduler::RequestScheduler(QObject *parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(m_maxConcurrent);
+    m_pool.setObjectName("RequestScheduler");
+}
+
+RequestScheduler::~RequestScheduler() {
+    // Aborted transfers return within one curl progress tick (at most about
+    // a second), so this does not stall shutdown on a slow provider
+    abortAll();
+    m_pool.waitForDone();
+}
+
+void RequestScheduler::setMode(Mode mode) {
+    QVector<quint64> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_mode = mode;
+        if (m_mode == Mode::Queue)
+            dropped = trimQueue();
+    }
+    for (quint64 id : dropped)
+        emit jobDropped(id);
+}
+
+RequestScheduler::Mode RequestScheduler::mode() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_mode;
+}
+
+void RequestScheduler::setMaxConcurrent(int jobs) {
+    QVector<Job> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maxConcurrent = qMax(1, jobs);
+        m_pool.setMaxThreadCount(m_maxConcurrent);
+        ready = takeStartable();
+    }
+    start(std::move(ready));
+}
+
+void RequestScheduler::setMaxQueued(int jobs) {
+    QVector<quint64> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maxQueued = qMax(0, jobs);
+        if (m_mode == Mode::Queue)
+            dropped = trimQueue();
+    }
+    for (quint64 id : dropped)
+        emit jobDropped(id);
+}
+
+quint64 RequestScheduler::enqueue(Job job, const Options &options,
+                                  QVector<quint64> *dropped) {
+    job.priority = options.priority;
+    job.aborted = std::make_shared<AbortSignal>();
+
+    QVector<Job> ready;
+    quint64 jobId;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        jobId = job.id = ++m_lastId;
+        job.batch = options.batch;
+
+        if (m_mode == Mode::Supersede) {
+            abortWhere([&job](const Job &other) {
+                bool sameBatch = job.batch != 0 && other.batch == job.batch;
+                return !sameBatch && other.priority <= job.priority;
+            });
+        }
+        m_jobs.append(std::move(job));
+        // A free slot is taken before trimming, so an idle scheduler never
+        // drops the job it was just given
+        ready = takeStartable();
+        if (m_mode == Mode::Queue)
+            *dropped = trimQueue();
+    }
+    start(std::move(ready));
+    return jobId;
+}
+
+quint64 RequestScheduler::submit(const QObject *owner, const Options &options, Work work) {
+    Job job;
+    job.owner = owner;
+    job.work = std::move(work);
+    QVector<quint64> dropped;
+    const quint64 jobId = enqueue(std::move(job), options, &dropped);
+    for (quint64 id : dropped)
+        emit jobDropped(id);
+    return jobId;
+}
+
+quint64 RequestScheduler::submitAsync(const QObject *owner, const Options &options,
+                                      AsyncWork work) {
+    Job job;
+    job.owner = owner;
+    job.asyncWork = std::move(work);
+    QVector<quint64> dropped;
+    const quint64 jobId = enqueue(std::move(job), options, &dropped);
+    for (quint64 id : dropped)
+        emit jobDropped(id);
+    return jobId;
+}
+
+void RequestScheduler::abort(quint64 jobId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    abortWhere([jobId](const Job &job) { return job.id == jobId; });
+}
+
+void RequestScheduler::abortOwnedBy(const QObject *owner) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    abortWhere([owner](const Job &job) { return job.owner == owner; });
+}
+
+void RequestScheduler::abortAll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    abortWhere([](const Job &) { return true; });
+}
+
+int RequestScheduler::activeJobs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobs.size();
+}
+
+template <typename Predicate>
+void RequestScheduler::abortWhere(Predicate predicate) {
+    // Waiting jobs are forgotten outright and never start. Running ones
+    // keep their entry, and their slot, until the transfer has unwound.
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        if (!predicate(*it)) {
+            ++it;
+            continue;
+        }
+        it->aborted->trigger();
+        it = it->started ? it + 1 : m_jobs.erase(it);
+    }
+}
+
+QVector<quint64> RequestScheduler::trimQueue() {
+    // Jobs of one batch (the tiles of a capture) count and are dropped together
+    QVector<quint64> dropped;
+    for (;;) {
+        QSet<quint64> batches;
+        int waiting = 0;
+        int victim = -1;
+        for (int i = 0; i < m_jobs.size(); ++i) {
+            const Job &job = m_jobs[i];
+            if (job.started || job.aborted->isAborted())
+                continue;
+            if (job.batch == 0 || !batches.contains(job.batch)) {
+                ++waiting;
+                batches.insert(job.batch);
+            }
+            if (victim < 0 || job.priority < m_jobs[victim].priority)
+                victim = i;
+        }
+        if (waiting <= m_maxQueued)
+            return dropped;
+
+        const quint64 batch = m_jobs[victim].batch;
+        const quint64 victimId = m_jobs[victim].id;
+        for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+            bool drop = !it->started && !it->aborted->isAborted()
+                        && (batch != 0 ? it->batch == batch : it->id == victimId);
+            if (!drop) {
+                ++it;
+                continue;
+            }
+            dropped.append(it->id);
+            it->aborted->trigger();
+            it = m_jobs.erase(it);
+        }
+    }
+}
+
+QVector<RequestScheduler::Job> RequestScheduler::takeStartable() {
+    // Highest priority first, oldest first within a priority
+    int running = 0;
+    for (const Job &job : m_jobs) {
+        if (job.started)
+            ++running;
+    }
+
+    QVector<Job> ready;
+    while (running < m_maxConcurrent) {
+        int next = -1;
+        for (int i = 0; i < m_jobs.size(); ++i) {
+            if (!m_jobs[i].started && (next < 0 || m_jobs[i].priority > m_jobs[next].priority))
+                next = i;
+        }
+        if (next < 0)
+            break;
+        Job &job = m_jobs[next];
+        job.started = true;
+        ready.append(job);
+        job.work = nullptr;
+        job.asyncWork = nullptr;
+        ++running;
+    }
+    return ready;
+}
+
+void RequestScheduler::start(QVector<Job> jobs) {
+    for (Job &job : jobs) {
+        const quint64 jobId = job.id;
+        AbortFlag aborted = job.aborted;
+        if (job.work) {
+            m_pool.start([this, jobId, aborted, work = std::move(job.work)]() {
+                run(jobId, aborted, work);
+            });
+            continue;
+        }
+
+        // Started from the event loop so the caller has the id before any
+        // callback can fire
+        QPointer<RequestScheduler> self(this);
+        QMetaObject::invokeMethod(this, [self, jobId, aborted, work = std::move(job.asyncWork)]() {
+            if (!self)
+                return;
+            if (aborted->isAborted()) {
+                self->finish(jobId);
+                return;
+            }
+            work(jobId, aborted, [self, jobId]() {
+                if (self)
+                    self->finish(jobId);
+            });
+        }, Qt::QueuedConnection);
+    }
+}
+
+void RequestScheduler::run(quint64 jobId, const AbortFlag &aborted, const Work &work) {
+    if (!aborted->isAborted())
+        work(jobId, aborted);
+    finish(jobId);
+}
+
+void RequestScheduler::finish(quint64 jobId) {
+    QVector<Job> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.removeIf([jobId](const Job &job) { return job.id == jobId; });
+        ready = takeStartable();
+    }
+    start(std::move(ready));
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+// Raised once when a job is aborted. Blocking transports poll flag();
+// event-driven ones register a callback, which runs on the aborting thread.
+class AbortSignal {
+public:
+    bool isAborted() const { return m_aborted.load(); }
+    const std::atomic<bool> *flag() const { return &m_aborted; }
+
+    // Runs immediately if already aborted; replaces any earlier callback
+    void onAbort(std::function<void()> callback) const;
+    void trigger();
+
+private:
+    std::atomic<bool> m_aborted{false};
+    mutable std::mutex m_mutex;
+    mutable std::function<void()> m_callback;
+};
+
+// Runs provider requests on its own bounded thread pool, so stalled
+// transfers never tie up QThreadPool::globalInstance() (which the capture
+// pipeline uses). Every job gets an abort flag. HttpSession polls that flag
+// from curl's progress callback, so an aborted transfer is torn down at the
+// next progress tick instead of running into its timeout. Event-driven
+// transports submit async jobs instead: they run on the scheduler's thread
+// rather than the pool, but wait for a slot under the same limit and hold it
+// until they report done.
+//
+// Jobs belong to a batch, which is normally one capture. In Supersede mode,
+// submitting a job from a new batch aborts every older job of equal or lower
+// priority. In Queue mode, jobs wait their turn with the highest priority
+// first; past maxQueued waiting jobs, the oldest lowest-priority ones are
+// dropped.
+class RequestScheduler : public QObject {
+    Q_OBJECT
+public:
+    enum class Mode {
+        Supersede,
+        Queue
+    };
+
+    enum class Priority {
+        Background,
+        Normal,
+        Interactive
+    };
+
+    struct Options {
+        Priority priority = Priority::Interactive;
+        quint64 batch = 0; // caller-chosen; 0 puts the job in a batch of its own
+    };
+
+    using AbortFlag = std::shared_ptr<const AbortSignal>;
+    using Work = std::function<void(quint64 jobId, const AbortFlag &aborted)>;
+    using AsyncWork = std::function<void(quint64 jobId, const AbortFlag &aborted,
+                                         std::function<void()> done)>;
+
+    explicit RequestScheduler(QObject *parent = nullptr);
+    ~RequestScheduler() override;
+
+    void setMode(Mode mode);
+    Mode mode() const;
+    void setMaxConcurrent(int jobs);
+    void setMaxQueued(int jobs);
+
+    // Returns the job id; owner is only used to abort jobs as a group
+    quint64 submit(const QObject *owner, const Options &options, Work work);
+    quint64 submitAsync(const QObject *owner, const Options &options, AsyncWork work);
+    void abort(quint64 jobId);
+    void abortOwnedBy(const QObject *owner);
+    void abortAll();
+
+    int activeJobs() const; // running plus waiting
+
+signals:
+    // A waiting job was dropped to keep the queue bounded; its work never runs
+    void jobDropped(quint64 jobId);
+
+private:
+    struct Job {
+        quint64 id = 0;
+        quint64 batch = 0;
+        Priority priority = Priority::Normal;
+        const QObject *owner = nullptr;
+        std::shared_ptr<AbortSignal> aborted;
+        bool started = false; // holds a slot
+        Work work;            // one of the two is set until the job starts
+        AsyncWork asyncWork;
+    };
+
+    // Registers the job, applies the mode and starts whatever fits; returns
+    // the id with the jobs dropped from the queue to make room
+    quint64 enqueue(Job job, const Options &options, QVector<quint64> *dropped);
+    void finish(quint64 jobId);
+
+    template <typename Predicate>
+    void abortWhere(Predicate predicate); // caller holds m_mutex
+    QVector<quint64> trimQueue();         // caller holds m_mutex
+    QVector<Job> takeStartable();         // caller holds m_mutex
+    void start(QVector<Job> jobs);
+    void run(quint64 jobId, const AbortFlag &aborted, const Work &work);
+
+    mutable std::mutex m_mutex;
+    QVector<Job> m_jobs; // oldest first
+    quint64 m_lastId = 0;
+    Mode m_mode = Mode::Supersede;
+    int m_maxConcurrent = 2;
+    int m_maxQueued = 4;
+
+    QThreadPool m_pool; // declared last so it drains before the rest goes away
+};
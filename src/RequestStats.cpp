@@ -0,0 +1,174 @@
+#include "RequestStats.h"
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+QString RequestStats::Context::label() const {
+    return QString("%1 / %2 / %3 / %4").arg(backend, model, encoder, transport);
+}
+
+void RequestStats::Rolling::record(double ms) {
+    if (windows[current].count() >= WINDOW) {
+        current ^= 1;
+        windows[current].reset();
+    }
+    windows[current].record(ms);
+}
+
+RequestStats::Percentiles RequestStats::Rolling::percentiles() const {
+    LatencyHistogram both = windows[0];
+    both.merge(windows[1]);
+
+    Percentiles result;
+    result.samples = both.count();
+    result.p50 = both.percentile(50);
+    result.p95 = both.percentile(95);
+    result.p99 = both.percentile(99);
+    result.max = both.max();
+    return result;
+}
+
+RequestStats::Entry &RequestStats::entry(const Context &context) {
+    auto it = m_entries.find(context.label());
+    if (it == m_entries.end()) {
+        it = m_entries.insert(context.label(), Entry());
+        it->context = context;
+    }
+    return *it;
+}
+
+RequestStats::HedgeScore &RequestStats::hedgeScore(const QString &backend,
+                                                   const QString &model) {
+    const QString key = backend + " / " + model;
+    auto it = m_hedgeScores.find(key);
+    if (it == m_hedgeScores.end()) {
+        it = m_hedgeScores.insert(key, HedgeScore());
+        it->backend = backend;
+        it->model = model;
+    }
+    return *it;
+}
+
+void RequestStats::recordEndToEnd(const Context &context, double ms) {
+    entry(context).endToEnd.record(ms);
+}
+
+void RequestStats::recordFirstByte(const Context &context, double ms) {
+    entry(context).firstByte.record(ms);
+}
+
+void RequestStats::recordEncode(const Context &context, double ms, qint64 bytes) {
+    Entry &e = entry(context);
+    e.encode.record(ms);
+    ++e.images;
+    e.imageBytes += quint64(qMax<qint64>(0, bytes));
+}
+
+void RequestStats::recordRequestBytes(const Context &context, qint64 bytes) {
+    Entry &e = entry(context);
+    ++e.requests;
+    e.requestBytes += quint64(qMax<qint64>(0, bytes));
+}
+
+void RequestStats::recordSuccess(const Context &context) {
+    ++entry(context).succeeded;
+}
+
+void RequestStats::recordFailure(const Context &context, bool timedOut) {
+    Entry &e = entry(context);
+    if (timedOut)
+        ++e.timeouts;
+    else
+        ++e.errors;
+}
+
+void RequestStats::recordCancel(const Context &context) {
+    ++entry(context).cancelled;
+}
+
+void RequestStats::clear() {
+    m_entries.clear();
+    m_hedgeScores.clear();
+}
+
+RequestStats::Summary RequestStats::summarize(const Entry &entry) {
+    Summary summary;
+    summary.context = entry.context;
+    summary.succeeded = entry.succeeded;
+    summary.errors = entry.errors;
+    summary.timeouts = entry.timeouts;
+    summary.cancelled = entry.cancelled;
+    summary.endToEnd = entry.endToEnd.percentiles();
+    summary.firstByte = entry.firstByte.percentiles();
+    summary.encode = entry.encode.percentiles();
+    summary.images = entry.images;
+    summary.imageBytes = entry.imageBytes;
+    summary.requests = entry.requests;
+    summary.requestBytes = entry.requestBytes;
+    return summary;
+}
+
+QVector<RequestStats::Summary> RequestStats::summaries() const {
+    QVector<Summary> result;
+    for (const Entry &e : m_entries)
+        result.append(summarize(e));
+    return result;
+}
+
+RequestStats::Summary RequestStats::summary(const Context &context) const {
+    auto it = m_entries.constFind(context.label());
+    if (it == m_entries.constEnd()) {
+        Summary empty;
+        empty.context = context;
+        return empty;
+    }
+    return summarize(*it);
+}
+
+static json percentilesJson(const RequestStats::Percentiles &p) {
+    return {{"samples", p.samples}, {"p50", p.p50}, {"p95", p.p95}, {"p99", p.p99},
+            {"max", p.max}};
+}
+
+QByteArray RequestStats::toJson(const TranslationCache::Stats &cache) const {
+    json contexts = json::array();
+    for (const Summary &s : summaries()) {
+        contexts.push_back({
+            {"backend", s.context.backend.toStdString()},
+            {"model", s.context.model.toStdString()},
+            {"encoder", s.context.encoder.toStdString()},
+            {"transport", s.context.transport.toStdString()},
+            {"succeeded", s.succeeded},
+            {"errors", s.errors},
+            {"timeouts", s.timeouts},
+            {"cancelled", s.cancelled},
+            {"end_to_end_ms", percentilesJson(s.endToEnd)},
+            {"first_byte_ms", percentilesJson(s.firstByte)},
+            {"encode_ms", percentilesJson(s.encode)},
+            {"images", s.images},
+            {"image_bytes", s.imageBytes},
+            {"requests", s.requests},
+            {"request_bytes", s.requestBytes}
+        });
+    }
+    json hedging = json::array();
+    for (const HedgeScore &h : m_hedgeScores) {
+        hedging.push_back({
+            {"backend", h.backend.toStdString()},
+            {"model", h.model.toStdString()},
+            {"races", h.races},
+            {"wins", h.wins},
+            {"win_rate", h.races == 0 ? 0.0 : double(h.wins) / h.races},
+            {"saved_ms", h.savedMs}
+        });
+    }
+    json root = {
+        {"window", WINDOW},
+        {"contexts", contexts},
+        {"hedging", hedging},
+        {"result_cache", {{"exact_hits", cache.exactHits}, {"near_hits", cache.nearHits},
+                          {"misses", cache.misses}}}
+    };
+    return QByteArray::fromStdString(root.dump(2));
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+#include "TranslationCache.h"
+#include <QByteArray>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+// Latency distributions and outcome counts per request context, so a change
+// of provider, model or encoder can be judged on numbers. Histograms are
+// rolling: two windows of WINDOW samples take turns and percentiles are read
+// over both, so older behaviour ages out. Counters cover the whole session.
+class RequestStats {
+public:
+    struct Context {
+        QString backend;
+        QString model;
+        QString encoder; // e.g. "jpeg q80", or "text" for local OCR
+        QString transport; // "curl" or "qt"
+
+        QString label() const;
+    };
+
+    struct Percentiles {
+        quint64 samples = 0;
+        double p50 = 0;
+        double p95 = 0;
+        double p99 = 0;
+        double max = 0;
+    };
+
+    struct Summary {
+        Context context;
+        quint64 succeeded = 0;
+        quint64 errors = 0;   // failures other than timeouts
+        quint64 timeouts = 0;
+        quint64 cancelled = 0;
+        Percentiles endToEnd;  // selection to result, per capture
+        Percentiles firstByte; // per request
+        Percentiles encode;    // per image, each tile on its own
+        quint64 images = 0;
+        quint64 imageBytes = 0;
+        quint64 requests = 0;  // request bodies sent, continuations included
+        quint64 requestBytes = 0;
+    };
+
+    void recordEndToEnd(const Context &context, double ms);
+    void recordFirstByte(const Context &context, double ms);
+    void recordEncode(const Context &context, double ms, qint64 bytes);
+    void recordRequestBytes(const Context &context, qint64 bytes);
+    void recordSuccess(const Context &context);
+    void recordFailure(const Context &context, bool timedOut);
+    void recordCancel(const Context &context);
+    void clear();
+
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    // Ordered by label; an unknown context gives an empty summary
+    QVector<Summary> summaries() const;
+    Summary summary(const Context &context) const;
+
+    // Hedged races, per backend and model rather than per pair, so a
+    // backend keeps its record when the other half changes
+    struct HedgeScore {
+        QString backend;
+        QString model;
+        quint64 races = 0;    // requests that reached both backends
+        quint64 wins = 0;
+        double savedMs = 0;   // estimated time won back over the other backend
+        double typicalMs = 0; // smoothed time from capture to a winning result
+    };
+    HedgeScore &hedgeScore(const QString &backend, const QString &model);
+    QVector<HedgeScore> hedgeScores() const { return m_hedgeScores.values(); }
+
+    // Result cache lookups are reported alongside; a hit never reaches a backend
+    QByteArray toJson(const TranslationCache::Stats &cache) const;
+
+    static constexpr quint64 WINDOW = 500;
+
+private:
+    struct Rolling {
+        LatencyHistogram windows[2];
+        int current = 0;
+
+        void record(double ms);
+        Percentiles percentiles() const;
+    };
+
+    struct Entry {
+        Context context;
+        Rolling endToEnd;
+        Rolling firstByte;
+        Rolling encode;
+        quint64 images = 0;
+        quint64 imageBytes = 0;
+        quint64 requests = 0;
+        quint64 requestBytes = 0;
+        quint64 succeeded = 0;
+        quint64 errors = 0;
+        quint64 timeouts = 0;
+        quint64 cancelled = 0;
+    };
+
+    Entry &entry(const Context &context);
+    static Summary summarize(const Entry &entry);
+
+    QMap<QString, Entry> m_entries; // by label
+    QMap<QString, HedgeScore> m_hedgeScores; // by backend and model
+};
@@ -0,0 +1,28 @@
+#include "RequestWriter.h"
+#include "Base64.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace RequestWriter {
+
+std::string bodyWithImage(const nlohmann::json &envelope, const QByteArray &image) {
+    const std::string skeleton = envelope.dump();
+    const size_t placeholderLen = std::strlen(IMAGE_PLACEHOLDER);
+    const size_t at = skeleton.find(IMAGE_PLACEHOLDER);
+    if (at == std::string::npos)
+        throw std::logic_error("request envelope has no image placeholder");
+
+    const size_t imageLen = Base64::encodedSize(size_t(image.size()));
+    std::string body;
+    body.resize(skeleton.size() - placeholderLen + imageLen);
+
+    std::memcpy(&body[0], skeleton.data(), at);
+    Base64::encode(reinterpret_cast<const unsigned char *>(image.constData()),
+                   size_t(image.size()), &body[at]);
+    std::memcpy(&body[at + imageLen], skeleton.data() + at + placeholderLen,
+                skeleton.size() - at - placeholderLen);
+    return body;
+}
+
+} // namespace RequestWriter
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QByteArray>
+#include <nlohmann/json.hpp>
+#include <string>
+
+// Serializes a request envelope around a large image without building the
+// base64 text as a JSON string node. The envelope carries IMAGE_PLACEHOLDER
+// where the encoded bytes belong (e.g. "data:image/png;base64,"
+// IMAGE_PLACEHOLDER); the body is sized once and the image is base64-encoded
+// straight into it, so the payload is touched in a single pass.
+namespace RequestWriter {
+
+inline constexpr const char IMAGE_PLACEHOLDER[] = "@@transit-image@@";
+
+std::string bodyWithImage(const nlohmann::json &envelope, const QByteArray &image);
+
+} // namespace RequestWriter
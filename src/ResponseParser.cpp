@@ -0,0 +1,454 @@
+#include "ResponseParser.h"
+
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace ResponseParser {
+
+namespace {
+
+// Records every string whose position matches a JsonPath
+class PathSax {
+public:
+    PathSax(const JsonPath &path, std::string *out) : m_path(path), m_out(out) {}
+
+    bool null() { return value(); }
+    bool boolean(bool) { return value(); }
+    bool number_integer(json::number_integer_t) { return value(); }
+    bool number_unsigned(json::number_unsigned_t) { return value(); }
+    bool number_float(json::number_float_t, const json::string_t &) { return value(); }
+    bool binary(json::binary_t &) { return value(); }
+
+    bool string(json::string_t &s) {
+        value();
+        if (atPath()) {
+            m_out->append(s);
+            m_matched = true;
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) {
+        value();
+        m_stack.push_back({false, -1, {}});
+        return true;
+    }
+    bool key(json::string_t &k) {
+        m_stack.back().key = std::move(k);
+        return true;
+    }
+    bool end_object() {
+        m_stack.pop_back();
+        return true;
+    }
+    bool start_array(std::size_t) {
+        value();
+        m_stack.push_back({true, -1, {}});
+        return true;
+    }
+    bool end_array() {
+        m_stack.pop_back();
+        return true;
+    }
+    bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) {
+        return false;
+    }
+
+    bool matched() const { return m_matched; }
+
+private:
+    struct Frame {
+        bool array;
+        int index;
+        std::string key;
+    };
+
+    bool value() {
+        if (!m_stack.empty() && m_stack.back().array)
+            ++m_stack.back().index;
+        return true;
+    }
+
+    bool atPath() const {
+        if (m_stack.size() != m_path.size())
+            return false;
+        for (size_t i = 0; i < m_stack.size(); ++i) {
+            const Frame &frame = m_stack[i];
+            const std::string &step = m_path[i];
+            if (!frame.array) {
+                if (frame.key != step)
+                    return false;
+            } else if (step != "*" && step != std::to_string(frame.index)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const JsonPath &m_path;
+    std::string *m_out;
+    std::vector<Frame> m_stack;
+    bool m_matched = false;
+};
+
+// Fills TextBlocks from the objects of one array. blocksDepth is the depth
+// of that array: 0 when the root object is itself the only block, 1 for a
+// bare top-level array, and 2 for the array under a root "blocks" key.
+class BlocksSax {
+public:
+    explicit BlocksSax(int blocksDepth)
+        : m_arrayDepth(blocksDepth == 2 ? -1 : blocksDepth), m_keyed(blocksDepth == 2) {}
+
+    bool null() { return scalar(); }
+    bool boolean(bool) { return scalar(); }
+    bool number_integer(json::number_integer_t v) { return number(double(v)); }
+    bool number_unsigned(json::number_unsigned_t v) { return number(double(v)); }
+    bool number_float(json::number_float_t v, const json::string_t &) { return number(v); }
+    bool binary(json::binary_t &) { return scalar(); }
+
+    bool string(json::string_t &s) {
+        if (atBlock() && m_field == Field::Text) {
+            m_text = QString::fromStdString(s);
+            m_hasText = true;
+        }
+        return scalar();
+    }
+
+    bool start_object(std::size_t) {
+        m_blocksNext = false;
+        ++m_depth;
+        if (inArray() && m_depth == m_arrayDepth + 1) {
+            m_text.clear();
+            m_hasText = false;
+            m_x = m_y = m_w = m_h = 0;
+        }
+        m_field = Field::None;
+        return true;
+    }
+
+    bool key(json::string_t &k) {
+        if (m_keyed && !inArray() && m_depth == 1)
+            m_blocksNext = k == "blocks";
+        if (atBlock())
+            m_field = fieldFor(k);
+        return true;
+    }
+
+    bool end_object() {
+        if (atBlock() && m_hasText) {
+            TextBlock tb;
+            tb.text = m_text;
+            tb.bbox = QRectF(m_x, m_y, m_w, m_h);
+            m_blocks.append(tb);
+        }
+        --m_depth;
+        m_field = Field::None;
+        // A lone block is complete once its object closes
+        if (m_arrayDepth == 0 && m_depth == 0) {
+            m_done = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t) {
+        ++m_depth;
+        if (m_blocksNext && m_depth == 2)
+            m_arrayDepth = 2;
+        m_blocksNext = false;
+        m_field = Field::None;
+        return true;
+    }
+
+    bool end_array() {
+        if (inArray() && m_depth == m_arrayDepth) {
+            // Nothing after the array matters
+            m_done = true;
+            return false;
+        }
+        --m_depth;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) {
+        return false;
+    }
+
+    bool done() const { return m_done; }
+    QVector<TextBlock> &blocks() { return m_blocks; }
+
+private:
+    enum class Field { None, Text, X, Y, W, H };
+
+    static Field fieldFor(const std::string &k) {
+        if (k == "text") return Field::Text;
+        if (k == "x") return Field::X;
+        if (k == "y") return Field::Y;
+        if (k == "w") return Field::W;
+        if (k == "h") return Field::H;
+        return Field::None;
+    }
+
+    bool inArray() const { return m_arrayDepth >= 0; }
+    bool atBlock() const { return inArray() && m_depth == m_arrayDepth + 1; }
+
+    bool scalar() {
+        m_blocksNext = false;
+        return true;
+    }
+
+    bool number(double v) {
+        if (atBlock()) {
+            switch (m_field) {
+            case Field::X: m_x = v; break;
+            case Field::Y: m_y = v; break;
+            case Field::W: m_w = v; break;
+            case Field::H: m_h = v; break;
+            default: break;
+            }
+        }
+        return scalar();
+    }
+
+    int m_depth = 0;
+    int m_arrayDepth;
+    bool m_keyed;
+    bool m_blocksNext = false;
+    bool m_done = false;
+
+    Field m_field = Field::None;
+    QString m_text;
+    bool m_hasText = false;
+    double m_x = 0, m_y = 0, m_w = 0, m_h = 0;
+    QVector<TextBlock> m_blocks;
+};
+
+// Collects the strings of one array: the one under a root "lines" key, or
+// the root itself when bare
+class LinesSax {
+public:
+    explicit LinesSax(bool keyed) : m_linesDepth(keyed ? -1 : 1) {}
+
+    bool null() { return scalar(); }
+    bool boolean(bool) { return scalar(); }
+    bool number_integer(json::number_integer_t) { return scalar(); }
+    bool number_unsigned(json::number_unsigned_t) { return scalar(); }
+    bool number_float(json::number_float_t, const json::string_t &) { return scalar(); }
+    bool binary(json::binary_t &) { return scalar(); }
+
+    bool string(json::string_t &s) {
+        if (inLines())
+            m_lines.append(QString::fromStdString(s));
+        return scalar();
+    }
+
+    bool start_object(std::size_t) {
+        ++m_depth;
+        m_linesNext = false;
+        return true;
+    }
+    bool key(json::string_t &k) {
+        m_linesNext = m_linesDepth < 0 && m_depth == 1 && k == "lines";
+        return true;
+    }
+    bool end_object() {
+        --m_depth;
+        return true;
+    }
+    bool start_array(std::size_t) {
+        ++m_depth;
+        if (m_linesNext)
+            m_linesDepth = m_depth;
+        m_linesNext = false;
+        return true;
+    }
+    bool end_array() {
+        if (inLines()) {
+            m_done = true;
+            return false;
+        }
+        --m_depth;
+        return true;
+    }
+    bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) {
+        return false;
+    }
+
+    bool done() const { return m_done; }
+    bool entered() const { return m_linesDepth > 0 && m_depth >= m_linesDepth; }
+    QVector<QString> &lines() { return m_lines; }
+
+private:
+    bool inLines() const { return m_linesDepth > 0 && m_depth == m_linesDepth; }
+    bool scalar() {
+        m_linesNext = false;
+        return true;
+    }
+
+    int m_depth = 0;
+    int m_linesDepth;
+    bool m_linesNext = false;
+    bool m_done = false;
+    QVector<QString> m_lines;
+};
+
+bool runBlocksSax(std::string_view content, size_t start, int blocksDepth,
+                  QVector<TextBlock> *blocks) {
+    BlocksSax sax(blocksDepth);
+    // Non-strict: whatever follows the document (a closing fence) is ignored
+    json::sax_parse(content.begin() + start, content.end(), &sax,
+                    json::input_format_t::json, false);
+    if (!sax.done())
+        return false;
+    *blocks = std::move(sax.blocks());
+    return true;
+}
+
+} // namespace
+
+bool extractText(std::string_view document, const JsonPath &path, std::string *text) {
+    PathSax sax(path, text);
+    bool ok = json::sax_parse(document.begin(), document.end(), &sax);
+    return ok && sax.matched();
+}
+
+QVector<TextBlock> parseBlocks(std::string_view content, bool *truncated) {
+    QVector<TextBlock> blocks;
+    if (truncated)
+        *truncated = false;
+
+    static constexpr std::string_view BLOCKS_KEY = "\"blocks\"";
+    size_t key = content.find(BLOCKS_KEY);
+    if (key != std::string_view::npos) {
+        // Usually the brace right before the key opens the document; if
+        // prose in front contained braces, the first one might instead
+        size_t nearest = content.rfind('{', key);
+        size_t first = content.find('{');
+        if (nearest != std::string_view::npos && runBlocksSax(content, nearest, 2, &blocks))
+            return blocks;
+        if (first != std::string_view::npos && first != nearest
+            && runBlocksSax(content, first, 2, &blocks))
+            return blocks;
+
+        // The streaming scanner resynchronises at every object boundary, so
+        // it keeps the blocks on either side of a malformed one and
+        // everything before a cut-off
+        if (truncated) {
+            BlockStreamParser scanner;
+            scanner.feed(content.substr(key));
+            *truncated = !scanner.isComplete();
+            return scanner.blocks();
+        }
+    } else {
+        size_t bracket = content.find('[');
+        if (bracket != std::string_view::npos && runBlocksSax(content, bracket, 1, &blocks))
+            return blocks;
+    }
+
+    throw std::runtime_error("response contains no valid blocks array");
+}
+
+bool parseBlock(std::string_view object, TextBlock *block) {
+    QVector<TextBlock> blocks;
+    if (!runBlocksSax(object, 0, 0, &blocks) || blocks.isEmpty())
+        return false;
+    *block = blocks.front();
+    return true;
+}
+
+QVector<QString> parseLines(std::string_view content, bool *truncated) {
+    *truncated = false;
+
+    static constexpr std::string_view LINES_KEY = "\"lines\"";
+    size_t key = content.find(LINES_KEY);
+    size_t start = key != std::string_view::npos ? content.rfind('{', key) : content.find('[');
+    if (start == std::string_view::npos)
+        throw std::runtime_error("response contains no lines array");
+
+    LinesSax sax(key != std::string_view::npos);
+    json::sax_parse(content.begin() + start, content.end(), &sax,
+                    json::input_format_t::json, false);
+    // A cut-off reply stops inside the array; anything else is not ours
+    if (!sax.done() && !sax.entered())
+        throw std::runtime_error("response contains no valid lines array");
+    *truncated = !sax.done();
+    return std::move(sax.lines());
+}
+
+ResponseFormat ResponseFormat::openAIChat() {
+    return {{"choices", "0", "message", "content"}, {"choices", "0", "delta", "content"}};
+}
+
+ResponseFormat ResponseFormat::geminiGenerate() {
+    return {{"candidates", "0", "content", "parts", "*", "text"},
+            {"candidates", "0", "content", "parts", "*", "text"}};
+}
+
+Decoder::Decoder(ResponseFormat format, bool streaming)
+    : m_format(std::move(format)), m_streaming(streaming) {}
+
+QVector<TextBlock> Decoder::feed(std::string_view chunk) {
+    QVector<TextBlock> fresh;
+    if (!m_streaming)
+        return fresh;
+
+    for (const std::string &event : m_sse.feed(chunk)) {
+        std::string piece;
+        if (!extractText(event, m_format.streamedContent, &piece))
+            continue;
+        m_content += piece;
+        if (m_scanFailed)
+            continue;
+        // Called from the transfer callbacks, so nothing may escape; finish()
+        // still parses the whole content
+        try {
+            fresh += m_blockParser.feed(piece);
+        } catch (const std::exception &) {
+            m_scanFailed = true;
+        }
+    }
+    return fresh;
+}
+
+QVector<TextBlock> Decoder::finish(const std::string &body) {
+    if (m_streaming) {
+        if (m_blockParser.isComplete())
+            return m_blockParser.blocks();
+        return parseBlocks(m_content, &m_truncated);
+    }
+
+    std::string content;
+    if (!extractText(body, m_format.content, &content))
+        throw std::runtime_error("unexpected response: " + body.substr(0, 200));
+    return parseBlocks(content, &m_truncated);
+}
+
+void Decoder::reset() {
+    m_sse = SseDecoder();
+    m_blockParser = BlockStreamParser();
+    m_content.clear();
+    m_scanFailed = false;
+    m_truncated = false;
+}
+
+LineDecoder::LineDecoder(ResponseFormat format, QVector<TextBlock> lines)
+    : m_format(std::move(format)), m_lines(std::move(lines)) {}
+
+QVector<TextBlock> LineDecoder::finish(const std::string &body) {
+    std::string content;
+    if (!extractText(body, m_format.content, &content))
+        throw std::runtime_error("unexpected response: " + body.substr(0, 200));
+
+    QVector<QString> translated = parseLines(content, &m_truncated);
+    if (translated.size() < m_lines.size())
+        m_truncated = true;
+
+    QVector<TextBlock> blocks = m_lines;
+    for (int i = 0; i < blocks.size() && i < translated.size(); ++i)
+        blocks[i].text = translated[i];
+    return blocks;
+}
+
+} // namespace ResponseParser
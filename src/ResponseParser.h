@@ -0,0 +1,86 @@
+#pragma once
+
+#include "AIService.h"
+#include "BlockStreamParser.h"
+#include "SseDecoder.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Decoding of provider responses without building JSON trees. Documents are
+// walked with nlohmann's SAX interface: envelope fields are matched against a
+// path as they stream past, and block fields are written straight into
+// TextBlocks.
+namespace ResponseParser {
+
+// Object keys and array positions from the root; "*" matches any position
+using JsonPath = std::vector<std::string>;
+
+// Concatenation of every string value at path, in document order. Returns
+// false if the document is not valid JSON or nothing matched.
+bool extractText(std::string_view document, const JsonPath &path, std::string *text);
+
+// Blocks of a {"blocks":[...]} reply. Markdown fences and prose around the
+// document are skipped, and a bare top-level array is accepted too. Throws
+// std::runtime_error when no well-formed blocks array is found.
+//
+// With truncated set, a damaged array is recovered instead: every complete,
+// well-formed block is kept, and *truncated tells whether the array was cut
+// off before its closing bracket.
+QVector<TextBlock> parseBlocks(std::string_view content, bool *truncated = nullptr);
+
+// One {"text","x","y","w","h"} object; false if it is malformed or has no text
+bool parseBlock(std::string_view object, TextBlock *block);
+
+// Strings of a {"lines":[...]} reply (or a bare array), tolerating the same
+// surroundings as parseBlocks(). A cut-off array keeps its complete strings
+// and sets *truncated. Throws std::runtime_error when there is no array.
+QVector<QString> parseLines(std::string_view content, bool *truncated);
+
+// Where the model's text sits in a provider's response
+struct ResponseFormat {
+    JsonPath content;         // whole response
+    JsonPath streamedContent; // each SSE event
+
+    static ResponseFormat openAIChat();
+    static ResponseFormat geminiGenerate();
+};
+
+// ResponseDecoder shared by the backends: SSE events or a whole body in,
+// blocks out, with complete blocks surfaced as soon as they stream in
+class Decoder : public AIService::ResponseDecoder {
+public:
+    Decoder(ResponseFormat format, bool streaming);
+
+    QVector<TextBlock> feed(std::string_view chunk) override;
+    QVector<TextBlock> finish(const std::string &body) override;
+    bool truncated() const override { return m_truncated; }
+    void reset() override;
+
+private:
+    ResponseFormat m_format;
+    bool m_streaming;
+    SseDecoder m_sse;
+    BlockStreamParser m_blockParser;
+    std::string m_content;
+    bool m_scanFailed = false; // blocks are no longer surfaced early
+    bool m_truncated = false;
+};
+
+// Decoder for text-only requests: entries of a {"lines":[...]} reply are
+// paired in order with the boxes of the recognised lines that were sent.
+// Lines the reply does not cover keep their original text.
+class LineDecoder : public AIService::ResponseDecoder {
+public:
+    LineDecoder(ResponseFormat format, QVector<TextBlock> lines);
+
+    QVector<TextBlock> finish(const std::string &body) override;
+    bool truncated() const override { return m_truncated; }
+
+private:
+    ResponseFormat m_format;
+    QVector<TextBlock> m_lines;
+    bool m_truncated = false;
+};
+
+} // namespace ResponseParser
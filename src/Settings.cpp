@@ -47,6 +47,38 @@ void Settings::setModelName(Backend backend, const QString &model) {
     emit settingsChanged();
 }
 
+bool Settings::streamResponses(Backend backend) const {
+    QSettings s;
+    return s.value("stream_responses/" + backendKey(backend), false).toBool();
+}
+
+void Settings::setStreamResponses(Backend backend, bool enabled) {
+    QSettings s;
+    s.setValue("stream_responses/" + backendKey(backend), enabled);
+    emit settingsChanged();
+}
+
+EncoderSettings Settings::encoderSettings(Backend backend) const {
+    QSettings s;
+    EncoderSettings encoder;
+    encoder.format = static_cast<EncoderSettings::Format>(
+        s.value("image_format/" + backendKey(backend), 0).toInt());
+    encoder.quality = s.value("image_quality/" + backendKey(backend), -1).toInt();
+    // Chosen on a machine that had the plugin
+    if (!isEncoderAvailable(encoder.format)) {
+        encoder.format = EncoderSettings::Format::Png;
+        encoder.quality = -1;
+    }
+    return encoder;
+}
+
+void Settings::setEncoderSettings(Backend backend, const EncoderSettings &encoder) {
+    QSettings s;
+    s.setValue("image_format/" + backendKey(backend), static_cast<int>(encoder.format));
+    s.setValue("image_quality/" + backendKey(backend), encoder.quality);
+    emit settingsChanged();
+}
+
 QString Settings::targetLanguage() const {
     QSettings s;
     return s.value("target_language", "English").toString();
@@ -69,6 +101,193 @@ void Settings::setActiveBackend(Backend backend) {
     emit settingsChanged();
 }
 
+bool Settings::hedgeRequests() const {
+    QSettings s;
+    return s.value("hedge_requests", false).toBool();
+}
+
+void Settings::setHedgeRequests(bool enabled) {
+    QSettings s;
+    s.setValue("hedge_requests", enabled);
+    emit settingsChanged();
+}
+
+Settings::Backend Settings::hedgeBackend() const {
+    QSettings s;
+    return static_cast<Backend>(s.value("hedge_backend", 1).toInt());
+}
+
+void Settings::setHedgeBackend(Backend backend) {
+    QSettings s;
+    s.setValue("hedge_backend", static_cast<int>(backend));
+    emit settingsChanged();
+}
+
+QString Settings::hedgeModel() const {
+    QSettings s;
+    return s.value("hedge_model").toString();
+}
+
+void Settings::setHedgeModel(const QString &model) {
+    QSettings s;
+    s.setValue("hedge_model", model);
+    emit settingsChanged();
+}
+
+int Settings::hedgeDelayMs() const {
+    QSettings s;
+    return s.value("hedge_delay_ms", 1500).toInt();
+}
+
+void Settings::setHedgeDelayMs(int ms) {
+    QSettings s;
+    s.setValue("hedge_delay_ms", ms);
+    emit settingsChanged();
+}
+
+int Settings::resultCacheSizeMB() const {
+    QSettings s;
+    return s.value("result_cache_mb", 16).toInt();
+}
+
+void Settings::setResultCacheSizeMB(int megabytes) {
+    QSettings s;
+    s.setValue("result_cache_mb", megabytes);
+    emit settingsChanged();
+}
+
+bool Settings::diskCacheEnabled() const {
+    QSettings s;
+    return s.value("disk_cache_enabled", false).toBool();
+}
+
+void Settings::setDiskCacheEnabled(bool enabled) {
+    QSettings s;
+    s.setValue("disk_cache_enabled", enabled);
+    emit settingsChanged();
+}
+
+int Settings::nearMatchThreshold() const {
+    QSettings s;
+    return s.value("near_match_threshold", 12).toInt();
+}
+
+void Settings::setNearMatchThreshold(int bits) {
+    QSettings s;
+    s.setValue("near_match_threshold", bits);
+    emit settingsChanged();
+}
+
+int Settings::targetTextHeight() const {
+    QSettings s;
+    return s.value("target_text_height", 0).toInt();
+}
+
+void Settings::setTargetTextHeight(int pixels) {
+    QSettings s;
+    s.setValue("target_text_height", pixels);
+    emit settingsChanged();
+}
+
+AIService::Transport Settings::transport() const {
+    QSettings s;
+    return static_cast<AIService::Transport>(s.value("http_transport", 0).toInt());
+}
+
+void Settings::setTransport(AIService::Transport transport) {
+    QSettings s;
+    s.setValue("http_transport", static_cast<int>(transport));
+    emit settingsChanged();
+}
+
+bool Settings::queueCaptures() const {
+    QSettings s;
+    return s.value("queue_captures", false).toBool();
+}
+
+void Settings::setQueueCaptures(bool enabled) {
+    QSettings s;
+    s.setValue("queue_captures", enabled);
+    emit settingsChanged();
+}
+
+bool Settings::continueTruncated() const {
+    QSettings s;
+    return s.value("continue_truncated", false).toBool();
+}
+
+void Settings::setContinueTruncated(bool enabled) {
+    QSettings s;
+    s.setValue("continue_truncated", enabled);
+    emit settingsChanged();
+}
+
+PreprocessOptions::ColorMode Settings::imageColorMode() const {
+    QSettings s;
+    return static_cast<PreprocessOptions::ColorMode>(s.value("image_color_mode", 0).toInt());
+}
+
+void Settings::setImageColorMode(PreprocessOptions::ColorMode mode) {
+    QSettings s;
+    s.setValue("image_color_mode", static_cast<int>(mode));
+    emit settingsChanged();
+}
+
+bool Settings::tileLargeCaptures() const {
+    QSettings s;
+    return s.value("tile_large_captures", false).toBool();
+}
+
+void Settings::setTileLargeCaptures(bool enabled) {
+    QSettings s;
+    s.setValue("tile_large_captures", enabled);
+    emit settingsChanged();
+}
+
+bool Settings::localOcr() const {
+    QSettings s;
+    return s.value("local_ocr", false).toBool();
+}
+
+void Settings::setLocalOcr(bool enabled) {
+    QSettings s;
+    s.setValue("local_ocr", enabled);
+    emit settingsChanged();
+}
+
+QString Settings::ocrLanguages() const {
+    QSettings s;
+    return s.value("ocr_languages", "eng").toString();
+}
+
+void Settings::setOcrLanguages(const QString &languages) {
+    QSettings s;
+    s.setValue("ocr_languages", languages);
+    emit settingsChanged();
+}
+
+int Settings::liveIntervalMs() const {
+    QSettings s;
+    return s.value("live_interval_ms", 1000).toInt();
+}
+
+void Settings::setLiveIntervalMs(int ms) {
+    QSettings s;
+    s.setValue("live_interval_ms", ms);
+    emit settingsChanged();
+}
+
+int Settings::translationMemorySizeMB() const {
+    QSettings s;
+    return s.value("translation_memory_mb", 4).toInt();
+}
+
+void Settings::setTranslationMemorySizeMB(int megabytes) {
+    QSettings s;
+    s.setValue("translation_memory_mb", megabytes);
+    emit settingsChanged();
+}
+
 QKeySequence Settings::hotkey() const {
     QSettings s;
     return QKeySequence(s.value("hotkey", "Ctrl+Alt+T").toString());
@@ -4,6 +4,10 @@
 #include <QString>
 #include <QKeySequence>
 
+#include "AIService.h"
+#include "ImageEncoder.h"
+#include "ImagePreprocessor.h"
+
 class Settings : public QObject {
     Q_OBJECT
 public:
@@ -27,6 +31,14 @@ public:
     QString modelName(Backend backend) const;
     void setModelName(Backend backend, const QString &model);
 
+    // Streamed responses (progressive overlay rendering)
+    bool streamResponses(Backend backend) const;
+    void setStreamResponses(Backend backend, bool enabled);
+
+    // Upload encoding
+    EncoderSettings encoderSettings(Backend backend) const;
+    void setEncoderSettings(Backend backend, const EncoderSettings &encoder);
+
     // Target language
     QString targetLanguage() const;
     void setTargetLanguage(const QString &lang);
@@ -35,6 +47,58 @@ public:
     Backend activeBackend() const;
     void setActiveBackend(Backend backend);
 
+    // Hedging: requests still running after the delay also go to a second
+    // backend or model, and the first result wins
+    bool hedgeRequests() const;
+    void setHedgeRequests(bool enabled);
+    Backend hedgeBackend() const;
+    void setHedgeBackend(Backend backend);
+    QString hedgeModel() const; // empty uses the hedge backend's model
+    void setHedgeModel(const QString &model);
+    int hedgeDelayMs() const;   // 0 sends to both at once
+    void setHedgeDelayMs(int ms);
+
+    // Translation result cache (0 MB disables it)
+    int resultCacheSizeMB() const;
+    void setResultCacheSizeMB(int megabytes);
+    bool diskCacheEnabled() const;
+    void setDiskCacheEnabled(bool enabled);
+    int nearMatchThreshold() const; // differing fingerprint bits, 0 = exact only
+    void setNearMatchThreshold(int bits);
+
+    // Capture preprocessing before upload
+    int targetTextHeight() const; // 0 keeps the capture resolution
+    void setTargetTextHeight(int pixels);
+    PreprocessOptions::ColorMode imageColorMode() const;
+    void setImageColorMode(PreprocessOptions::ColorMode mode);
+    // Split large captures into tiles translated in parallel
+    bool tileLargeCaptures() const;
+    void setTileLargeCaptures(bool enabled);
+
+    // Recognise text offline and send only the text (needs a Tesseract build)
+    bool localOcr() const;
+    void setLocalOcr(bool enabled);
+    QString ocrLanguages() const; // Tesseract codes, e.g. "eng+jpn"
+    void setOcrLanguages(const QString &languages);
+    // How often a live region is re-grabbed and diffed
+    int liveIntervalMs() const;
+    void setLiveIntervalMs(int ms);
+    // Remembered line translations for the local OCR path (0 MB disables it)
+    int translationMemorySizeMB() const;
+    void setTranslationMemorySizeMB(int megabytes);
+
+    // HTTP stack used for provider requests
+    AIService::Transport transport() const;
+    void setTransport(AIService::Transport transport);
+
+    // Let a new capture wait behind unfinished ones instead of replacing them
+    bool queueCaptures() const;
+    void setQueueCaptures(bool enabled);
+
+    // Request the rest of a reply cut off by the output token limit
+    bool continueTruncated() const;
+    void setContinueTruncated(bool enabled);
+
     // Hotkey
     QKeySequence hotkey() const;
     void setHotkey(const QKeySequence &key);
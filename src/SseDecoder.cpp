@@ -0,0 +1,37 @@
+#include "SseDecoder.h"
+
+std::vector<std::string> SseDecoder::feed(std::string_view chunk) {
+    std::vector<std::string> events;
+
+    for (char c : chunk) {
+        if (c != '\n') {
+            m_line.push_back(c);
+            continue;
+        }
+
+        if (!m_line.empty() && m_line.back() == '\r')
+            m_line.pop_back();
+
+        if (m_line.empty()) {
+            // Blank line terminates the event
+            if (m_hasData)
+                events.push_back(std::move(m_data));
+            m_data.clear();
+            m_hasData = false;
+        } else if (m_line.compare(0, 5, "data:") == 0) {
+            std::string_view value(m_line);
+            value.remove_prefix(5);
+            if (!value.empty() && value.front() == ' ')
+                value.remove_prefix(1);
+            if (m_hasData)
+                m_data.push_back('\n');
+            m_data.append(value);
+            m_hasData = true;
+        }
+        // event:, id:, retry: and comments are not used by the providers
+
+        m_line.clear();
+    }
+
+    return events;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Incremental decoder for text/event-stream bodies. Bytes are fed as they
+// arrive off the wire; every completed event yields its (joined) data field.
+class SseDecoder {
+public:
+    std::vector<std::string> feed(std::string_view chunk);
+
+private:
+    std::string m_line;
+    std::string m_data;
+    bool m_hasData = false;
+};
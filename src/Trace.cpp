@@ -0,0 +1,139 @@
+#include "Trace.h"
+
+#include <QElapsedTimer>
+#include <QSaveFile>
+#include <QSet>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace Trace {
+
+namespace {
+
+struct Event {
+    const char *name = nullptr;
+    quint64 track = 0;
+    qint64 start = 0;
+    qint64 duration = 0;
+    const char *connection = nullptr; // request spans only
+    const char *protocol = nullptr;
+};
+
+struct Buffer {
+    std::mutex mutex;
+    std::vector<Event> events = std::vector<Event>(CAPACITY);
+    size_t next = 0;  // slot the next event goes into
+    size_t count = 0;
+};
+
+Buffer &buffer() {
+    static Buffer instance;
+    return instance;
+}
+
+const QElapsedTimer &clock() {
+    static const QElapsedTimer timer = [] {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer;
+}
+
+} // namespace
+
+qint64 now() {
+    return clock().nsecsElapsed() / 1000;
+}
+
+static void append(const Event &event) {
+    Buffer &b = buffer();
+    std::lock_guard<std::mutex> lock(b.mutex);
+    b.events[b.next] = event;
+    b.next = (b.next + 1) % b.events.size();
+    b.count = qMin(b.count + 1, b.events.size());
+}
+
+void record(const char *name, quint64 track, qint64 startUs, qint64 endUs) {
+    append(Event{name, track, startUs, qMax<qint64>(0, endUs - startUs)});
+}
+
+void recordRequest(quint64 track, qint64 startUs, const RequestTiming &timing) {
+    if (timing.endUs < 0)
+        return;
+
+    Event request{"request", track, startUs, timing.endUs};
+    request.connection = timing.connection;
+    request.protocol = timing.protocol;
+    append(request);
+
+    // Stages follow each other; a missing one takes no time
+    qint64 at = 0;
+    if (timing.connectedUs >= 0) {
+        record("connect", track, startUs, startUs + timing.connectedUs);
+        at = timing.connectedUs;
+    }
+    if (timing.secureUs > at) {
+        record("tls", track, startUs + at, startUs + timing.secureUs);
+        at = timing.secureUs;
+    }
+    if (timing.firstByteUs >= at) {
+        record("upload + first byte", track, startUs + at, startUs + timing.firstByteUs);
+        at = timing.firstByteUs;
+    }
+    record("download", track, startUs + at, startUs + qMax(at, timing.endUs));
+}
+
+QByteArray chromeJson() {
+    std::vector<Event> events;
+    {
+        Buffer &b = buffer();
+        std::lock_guard<std::mutex> lock(b.mutex);
+        events.reserve(b.count);
+        const size_t first = (b.next + b.events.size() - b.count) % b.events.size();
+        for (size_t i = 0; i < b.count; ++i)
+            events.push_back(b.events[(first + i) % b.events.size()]);
+    }
+
+    json traceEvents = json::array();
+    QSet<quint64> tracks;
+    for (const Event &event : events) {
+        json traceEvent = {
+            {"name", event.name}, {"cat", "transit"}, {"ph", "X"},
+            {"ts", event.start}, {"dur", event.duration},
+            {"pid", 1}, {"tid", event.track}
+        };
+        if (event.connection)
+            traceEvent["args"]["connection"] = event.connection;
+        if (event.protocol)
+            traceEvent["args"]["protocol"] = event.protocol;
+        traceEvents.push_back(std::move(traceEvent));
+        tracks.insert(event.track);
+    }
+    // Row labels
+    for (quint64 track : tracks) {
+        std::string label = track == 0 ? "other" : "capture " + std::to_string(track);
+        traceEvents.push_back({
+            {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", track},
+            {"args", {{"name", label}}}
+        });
+    }
+
+    json root = {{"traceEvents", traceEvents}, {"displayTimeUnit", "ms"}};
+    return QByteArray::fromStdString(root.dump());
+}
+
+bool writeChromeJson(const QString &path, QString *error) {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(chromeJson()) < 0 || !file.commit()) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+} // namespace Trace
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+// Process-wide ring buffer of timed spans for the stages of a capture, from
+// the hotkey to the overlay's first paint. Each span carries a track, the
+// capture id, so a capture reads as one row when the buffer is exported as
+// Chrome trace_event JSON (chrome://tracing or ui.perfetto.dev).
+//
+// Recording takes a mutex and copies a few words, so it stays on in release
+// builds; the oldest spans are overwritten once the buffer is full.
+namespace Trace {
+
+// Microseconds on a monotonic clock shared by all threads
+qint64 now();
+
+// name must outlive the buffer (a string literal)
+void record(const char *name, quint64 track, qint64 startUs, qint64 endUs);
+
+// Stages of one HTTP exchange, as offsets in microseconds from the moment the
+// request was handed to the transport; -1 where a stage did not happen
+// (no connect on a reused connection, no TLS over plain HTTP). The exchange
+// as a whole is recorded as a "request" span carrying the connection and
+// protocol.
+struct RequestTiming {
+    qint64 connectedUs = -1;
+    qint64 secureUs = -1;
+    qint64 firstByteUs = -1;
+    qint64 endUs = -1;
+    const char *connection = nullptr; // "new" or "reused"; null if unknown
+    const char *protocol = nullptr;   // "http/1.1", "h2" or "h3"; null if unknown
+};
+void recordRequest(quint64 track, qint64 startUs, const RequestTiming &timing);
+
+// Records from construction to destruction
+class Span {
+public:
+    Span(const char *name, quint64 track) : m_name(name), m_track(track), m_start(now()) {}
+    ~Span() { record(m_name, m_track, m_start, now()); }
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+private:
+    const char *m_name;
+    quint64 m_track;
+    qint64 m_start;
+};
+
+QByteArray chromeJson();
+bool writeChromeJson(const QString &path, QString *error = nullptr);
+
+inline constexpr int CAPACITY = 8192;
+
+} // namespace Trace
@@ -0,0 +1,163 @@
+#include "TrafficArchive.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+
+namespace TrafficArchive {
+
+static constexpr quint32 FILE_MAGIC = 0x54545231; // "TTR1"
+
+static QByteArray serialize(const Round &round) {
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << round.backend << round.endpoint << qint32(round.round) << round.requestBytes
+        << qint32(round.statusCode) << round.error << round.timedOut
+        << round.firstByteUs << round.endUs << round.body << round.chunkUs << round.chunkEnds;
+    return qCompress(record);
+}
+
+static bool deserialize(const QByteArray &compressed, Round *round) {
+    const QByteArray record = qUncompress(compressed);
+    if (record.isEmpty())
+        return false;
+    QDataStream in(record);
+    in.setVersion(QDataStream::Qt_6_0);
+    qint32 number = 0;
+    qint32 statusCode = 0;
+    in >> round->backend >> round->endpoint >> number >> round->requestBytes
+       >> statusCode >> round->error >> round->timedOut
+       >> round->firstByteUs >> round->endUs >> round->body >> round->chunkUs >> round->chunkEnds;
+    round->round = number;
+    round->statusCode = statusCode;
+    if (in.status() != QDataStream::Ok || round->chunkUs.size() != round->chunkEnds.size())
+        return false;
+
+    // Replay slices the body at these positions
+    qint32 previous = 0;
+    for (qint32 end : round->chunkEnds) {
+        if (end < previous || end > round->body.size())
+            return false;
+        previous = end;
+    }
+    return true;
+}
+
+static bool readMagic(QDataStream &in) {
+    quint32 magic = 0;
+    in >> magic;
+    return in.status() == QDataStream::Ok && magic == FILE_MAGIC;
+}
+
+bool Recorder::open(const QString &path, QString *error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // Never append records to something that is not an archive
+    QFile existing(path);
+    if (existing.size() > 0) {
+        QDataStream in(&existing);
+        in.setVersion(QDataStream::Qt_6_0);
+        if (!existing.open(QIODevice::ReadOnly) || !readMagic(in)) {
+            if (error)
+                *error = "not a traffic archive";
+            return false;
+        }
+
+        // A record cut short by a crash would swallow everything appended
+        // after it, so the file is cut back to the last complete record
+        qint64 end = existing.pos();
+        while (!in.atEnd()) {
+            QByteArray record;
+            in >> record;
+            if (in.status() != QDataStream::Ok)
+                break;
+            end = existing.pos();
+        }
+        existing.close();
+        if (end < existing.size() && !existing.resize(end)) {
+            if (error)
+                *error = existing.errorString();
+            return false;
+        }
+    }
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        if (error)
+            *error = m_file.errorString();
+        return false;
+    }
+    if (m_file.size() == 0) {
+        QDataStream out(&m_file);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << FILE_MAGIC;
+    }
+    return true;
+}
+
+void Recorder::append(const Round &round) {
+    const QByteArray record = serialize(round);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.isOpen())
+        return;
+    QDataStream out(&m_file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << record;
+    m_file.flush();
+}
+
+bool load(const QString &path, QVector<Round> *rounds, QString *error) {
+    rounds->clear();
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    const QByteArray data = file.readAll();
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_6_0);
+    if (!readMagic(in)) {
+        if (error)
+            *error = "not a traffic archive";
+        return false;
+    }
+
+    while (!in.atEnd()) {
+        QByteArray record;
+        in >> record;
+        if (in.status() != QDataStream::Ok)
+            break; // the last record was cut short
+        Round round;
+        if (!deserialize(record, &round)) {
+            if (error)
+                *error = QString("record %1 is damaged").arg(rounds->size());
+            return false;
+        }
+        rounds->append(std::move(round));
+    }
+    return true;
+}
+
+Replay::Replay(QVector<Round> rounds, double speed)
+    : m_rounds(std::move(rounds)), m_speed(speed) {}
+
+bool Replay::next(const QString &backend, Round *round) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const int count = m_rounds.size();
+    int &cursor = m_cursors[backend];
+    for (int i = 0; i < count; ++i) {
+        const int index = (cursor + i) % count;
+        if (m_rounds[index].backend == backend) {
+            *round = m_rounds[index];
+            cursor = index + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace TrafficArchive
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <mutex>
+
+// Provider traffic captured inside the backends, to be served back later
+// with its original timing. A round is one HTTP request and its response.
+// Of the request only the endpoint and size are kept, never the body or
+// the query string, so an archive holds no images or credentials.
+//
+// Archives are append-only: a header, then one zlib-compressed record per
+// round, so a session that ends abruptly keeps what it recorded.
+namespace TrafficArchive {
+
+struct Round {
+    QString backend;           // AIService::name()
+    QString endpoint;          // URL path
+    int round = 0;             // continuation number; 0 for the first request
+    qint64 requestBytes = 0;
+    int statusCode = 0;
+    QString error;             // transport failure, empty otherwise
+    bool timedOut = false;
+    qint64 firstByteUs = -1;   // offsets from handing the request over
+    qint64 endUs = -1;
+    QByteArray body;
+    // How the body of an HTTP 200 response reached the decoder: arrival
+    // offset and end position of each piece
+    QVector<qint64> chunkUs;
+    QVector<qint32> chunkEnds;
+};
+
+class Recorder {
+public:
+    // Appends to the file, writing the header if it is new; refuses a
+    // non-empty file that is not an archive
+    bool open(const QString &path, QString *error = nullptr);
+    // Thread-safe; curl rounds finish on the scheduler's threads
+    void append(const Round &round);
+
+private:
+    std::mutex m_mutex;
+    QFile m_file;
+};
+
+// Every round in the file, oldest first. A record cut short at the end (a
+// crash while writing) is dropped; anything else malformed fails the load.
+bool load(const QString &path, QVector<Round> *rounds, QString *error = nullptr);
+
+// Serves each backend's rounds in recorded order and starts over after the
+// last. Matching by order rather than by request keeps a replay usable when
+// encoding changes alter every body.
+class Replay {
+public:
+    // speed scales the recorded delays: 2 replays twice as fast, 0 at once
+    explicit Replay(QVector<Round> rounds, double speed = 1.0);
+
+    // False if nothing was recorded for the backend
+    bool next(const QString &backend, Round *round);
+    double speed() const { return m_speed; }
+    int size() const { return m_rounds.size(); }
+
+private:
+    std::mutex m_mutex;
+    QVector<Round> m_rounds;
+    QHash<QString, int> m_cursors; // per backend, the index to search from
+    double m_speed;
+};
+
+} // namespace TrafficArchive
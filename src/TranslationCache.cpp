@@ -0,0 +1,223 @@
+#include "TranslationCache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+static constexpr quint32 DISK_MAGIC = 0x54494331; // "TIC1"
+
+TranslationCache::TranslationCache(qint64 memoryLimitBytes)
+    : m_memoryLimit(memoryLimitBytes) {}
+
+TranslationCache::Query TranslationCache::makeQuery(const QImage &image,
+                                                    const QString &targetLanguage,
+                                                    const QString &backend,
+                                                    const QString &model,
+                                                    bool withFingerprint) {
+    Query query;
+    query.context = (targetLanguage + QChar(0) + backend + QChar(0) + model).toUtf8();
+
+    // Two independently seeded chains over the visible bytes of each
+    // scanline (padding excluded) give a 128-bit pixel fingerprint.
+    const size_t rowBytes = size_t(image.width()) * size_t(image.depth()) / 8;
+    size_t h1 = 0x243f6a88;
+    size_t h2 = 0x13198a2e;
+    for (int y = 0; y < image.height(); ++y) {
+        const uchar *line = image.constScanLine(y);
+        h1 = qHashBits(line, rowBytes, h1);
+        h2 = qHashBits(line, rowBytes, h2);
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(&h1), sizeof(h1)));
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(&h2), sizeof(h2)));
+    hash.addData(QString("%1x%2:%3").arg(image.width()).arg(image.height())
+                     .arg(int(image.format())).toUtf8());
+    hash.addData(query.context);
+    query.key = hash.result();
+
+    if (withFingerprint)
+        query.fingerprint = computeFingerprint(image);
+    return query;
+}
+
+bool TranslationCache::lookup(const Query &query, QVector<TextBlock> *blocks) {
+    if (lookupKey(query.key, blocks)) {
+        ++m_stats.exactHits;
+        return true;
+    }
+
+    if (m_similarityThreshold > 0 && !query.fingerprint.isNull()) {
+        auto index = m_similar.constFind(query.context);
+        if (index != m_similar.constEnd()) {
+            QByteArray nearKey = index->findNearest(query.fingerprint, m_similarityThreshold);
+            if (!nearKey.isEmpty() && lookupKey(nearKey, blocks)) {
+                ++m_stats.nearHits;
+                return true;
+            }
+        }
+    }
+
+    ++m_stats.misses;
+    return false;
+}
+
+bool TranslationCache::lookupKey(const QByteArray &key, QVector<TextBlock> *blocks) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it.value());
+        *blocks = it.value()->blocks;
+        return true;
+    }
+
+    if (!m_diskDir.isEmpty() && readFromDisk(key, blocks)) {
+        insertInMemory(key, *blocks);
+        return true;
+    }
+    return false;
+}
+
+void TranslationCache::insert(const Query &query, const QVector<TextBlock> &blocks) {
+    insertInMemory(query.key, blocks);
+    if (!m_diskDir.isEmpty()) {
+        writeToDisk(query.key, blocks);
+        if (m_diskUsage > m_diskLimit)
+            trimDisk();
+    }
+
+    if (!query.fingerprint.isNull()) {
+        PerceptualIndex &index = m_similar[query.context];
+        index.insert(query.fingerprint, query.key);
+        index.shrinkTo(MAX_FINGERPRINTS);
+    }
+}
+
+void TranslationCache::clear() {
+    m_lru.clear();
+    m_index.clear();
+    m_similar.clear();
+    m_memoryUsage = 0;
+}
+
+void TranslationCache::setMemoryLimit(qint64 bytes) {
+    m_memoryLimit = bytes;
+    evictToLimit();
+}
+
+void TranslationCache::setDiskDirectory(const QString &path, qint64 limitBytes) {
+    m_diskDir = path;
+    m_diskLimit = limitBytes;
+    if (m_diskDir.isEmpty())
+        return;
+
+    QDir().mkpath(m_diskDir);
+    trimDisk(); // also takes stock of what earlier runs left
+}
+
+qint64 TranslationCache::costOf(const QByteArray &key, const QVector<TextBlock> &blocks) {
+    qint64 cost = qint64(sizeof(Entry)) + key.size();
+    for (const auto &b : blocks)
+        cost += qint64(sizeof(TextBlock)) + b.text.size() * qint64(sizeof(QChar));
+    return cost;
+}
+
+void TranslationCache::insertInMemory(const QByteArray &key, const QVector<TextBlock> &blocks) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_memoryUsage -= it.value()->cost;
+        m_lru.erase(it.value());
+        m_index.erase(it);
+    }
+
+    Entry entry{key, blocks, costOf(key, blocks)};
+    if (entry.cost > m_memoryLimit)
+        return;
+
+    m_memoryUsage += entry.cost;
+    m_lru.push_front(std::move(entry));
+    m_index.insert(key, m_lru.begin());
+    evictToLimit();
+}
+
+void TranslationCache::evictToLimit() {
+    while (m_memoryUsage > m_memoryLimit && !m_lru.empty()) {
+        m_memoryUsage -= m_lru.back().cost;
+        m_index.remove(m_lru.back().key);
+        m_lru.pop_back();
+    }
+}
+
+QString TranslationCache::diskPath(const QByteArray &key) const {
+    return m_diskDir + '/' + QString::fromLatin1(key.toHex()) + ".tic";
+}
+
+bool TranslationCache::readFromDisk(const QByteArray &key, QVector<TextBlock> *blocks) const {
+    QFile file(diskPath(key));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 count = 0;
+    in >> magic >> count;
+    if (magic != DISK_MAGIC)
+        return false;
+
+    QVector<TextBlock> loaded;
+    loaded.reserve(int(qMin<quint32>(count, 4096)));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        TextBlock tb;
+        in >> tb.text >> tb.bbox;
+        loaded.append(tb);
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    *blocks = loaded;
+    return true;
+}
+
+void TranslationCache::writeToDisk(const QByteArray &key, const QVector<TextBlock> &blocks) {
+    const QString path = diskPath(key);
+    const QFileInfo previous(path);
+    const qint64 replaced = previous.exists() ? previous.size() : 0;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << DISK_MAGIC << quint32(blocks.size());
+    for (const auto &b : blocks)
+        out << b.text << b.bbox;
+    const qint64 written = file.size();
+    if (file.commit())
+        m_diskUsage += written - replaced;
+}
+
+void TranslationCache::trimDisk() {
+    QDir dir(m_diskDir);
+    const QFileInfoList files = dir.entryInfoList({"*.tic"}, QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const QFileInfo &info : files)
+        total += info.size();
+    m_diskUsage = total;
+    if (total <= m_diskLimit)
+        return;
+
+    // Newest entries are kept up to a fraction of the budget, so the
+    // directory is only listed again after a good number of inserts
+    const qint64 keep = m_diskLimit / 4 * 3;
+    m_diskUsage = 0;
+    for (const QFileInfo &info : files) {
+        if (m_diskUsage + info.size() <= keep)
+            m_diskUsage += info.size();
+        else if (!QFile::remove(info.absoluteFilePath()))
+            m_diskUsage += info.size();
+    }
+}
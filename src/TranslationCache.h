@@ -0,0 +1,89 @@
+#pragma once
+
+#include "AIService.h"
+#include "PerceptualHash.h"
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QString>
+#include <list>
+
+// Content-addressed LRU cache of translation results. Keys combine a hash
+// of the raw captured pixels with everything else that changes the answer
+// (target language, backend, model), so an identical capture is served
+// without a round trip. An optional disk tier persists entries across runs.
+//
+// With a similarity threshold set, captures that miss the exact key are
+// matched against perceptual fingerprints of earlier captures in the same
+// context, so a selection that is a pixel off still reuses the result.
+class TranslationCache {
+public:
+    struct Query {
+        QByteArray key;
+        QByteArray context;
+        ImageFingerprint fingerprint;
+
+        bool isNull() const { return key.isEmpty(); }
+    };
+
+    struct Stats {
+        quint64 exactHits = 0;
+        quint64 nearHits = 0;
+        quint64 misses = 0;
+    };
+
+    explicit TranslationCache(qint64 memoryLimitBytes = 16 * 1024 * 1024);
+
+    // Thread-safe; the fingerprint is only computed when requested
+    static Query makeQuery(const QImage &image, const QString &targetLanguage,
+                           const QString &backend, const QString &model,
+                           bool withFingerprint);
+
+    bool lookup(const Query &query, QVector<TextBlock> *blocks);
+    void insert(const Query &query, const QVector<TextBlock> &blocks);
+    void clear();
+
+    // Maximum Hamming distance (of 256 bits) for a near match; 0 disables
+    void setSimilarityThreshold(int maxBits) { m_similarityThreshold = maxBits; }
+    int similarityThreshold() const { return m_similarityThreshold; }
+    const Stats &stats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
+    void setMemoryLimit(qint64 bytes);
+    qint64 memoryUsage() const { return m_memoryUsage; }
+
+    // Empty path disables the disk tier
+    void setDiskDirectory(const QString &path, qint64 limitBytes);
+
+private:
+    struct Entry {
+        QByteArray key;
+        QVector<TextBlock> blocks;
+        qint64 cost = 0;
+    };
+
+    bool lookupKey(const QByteArray &key, QVector<TextBlock> *blocks);
+    static qint64 costOf(const QByteArray &key, const QVector<TextBlock> &blocks);
+    void insertInMemory(const QByteArray &key, const QVector<TextBlock> &blocks);
+    void evictToLimit();
+
+    QString diskPath(const QByteArray &key) const;
+    bool readFromDisk(const QByteArray &key, QVector<TextBlock> *blocks) const;
+    void writeToDisk(const QByteArray &key, const QVector<TextBlock> &blocks);
+    void trimDisk();
+
+    std::list<Entry> m_lru; // most recently used first
+    QHash<QByteArray, std::list<Entry>::iterator> m_index;
+    qint64 m_memoryLimit;
+    qint64 m_memoryUsage = 0;
+
+    QString m_diskDir;
+    qint64 m_diskLimit = 0;
+    qint64 m_diskUsage = 0; // kept up to date by writes, recounted by trimDisk()
+
+    QHash<QByteArray, PerceptualIndex> m_similar; // per context
+    int m_similarityThreshold = 0;
+    Stats m_stats;
+
+    static constexpr int MAX_FINGERPRINTS = 4096;
+};
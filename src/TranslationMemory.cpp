@@ -0,0 +1,154 @@
+#include "TranslationMemory.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+
+static constexpr quint32 FILE_MAGIC = 0x54544d31; // "TTM1"
+
+TranslationMemory::TranslationMemory(qint64 memoryLimitBytes)
+    : m_memoryLimit(memoryLimitBytes) {}
+
+bool TranslationMemory::needsTranslation(const QString &source) {
+    for (QChar c : source) {
+        if (c.isLetter())
+            return true;
+    }
+    return false;
+}
+
+quint64 TranslationMemory::keyOf(const QString &source, const QString &targetLanguage) {
+    // A stable digest: the keys outlive the process, so qHash's seeding won't do
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(targetLanguage.toUtf8());
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(source.simplified().toUtf8());
+    return qFromLittleEndian<quint64>(hash.result().constData());
+}
+
+bool TranslationMemory::lookup(const QString &source, const QString &targetLanguage,
+                               QString *translation) {
+    if (source.size() > MAX_SOURCE_LENGTH || !needsTranslation(source))
+        return false;
+
+    auto it = m_index.find(keyOf(source, targetLanguage));
+    if (it == m_index.end()) {
+        ++m_stats.misses;
+        return false;
+    }
+
+    m_lru.splice(m_lru.begin(), m_lru, it.value());
+    *translation = QString::fromUtf8(it.value()->translation);
+    ++m_stats.hits;
+    return true;
+}
+
+void TranslationMemory::insert(const QString &source, const QString &targetLanguage,
+                               const QString &translation) {
+    if (source.size() > MAX_SOURCE_LENGTH || !needsTranslation(source) || translation.isEmpty())
+        return;
+
+    insertKey(keyOf(source, targetLanguage), translation.toUtf8());
+    m_dirty = true;
+}
+
+void TranslationMemory::clear() {
+    m_dirty = m_dirty || !m_lru.empty();
+    m_lru.clear();
+    m_index.clear();
+    m_memoryUsage = 0;
+}
+
+void TranslationMemory::setMemoryLimit(qint64 bytes) {
+    m_memoryLimit = bytes;
+    evictToLimit();
+}
+
+qint64 TranslationMemory::costOf(const Entry &entry) {
+    // List node, hash node and the string's heap block, roughly
+    return qint64(sizeof(Entry)) + 48 + entry.translation.capacity();
+}
+
+void TranslationMemory::insertKey(quint64 key, QByteArray translation) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_memoryUsage -= costOf(*it.value());
+        m_lru.erase(it.value());
+        m_index.erase(it);
+    }
+
+    Entry entry{key, std::move(translation)};
+    const qint64 cost = costOf(entry);
+    if (cost > m_memoryLimit)
+        return;
+
+    m_memoryUsage += cost;
+    m_lru.push_front(std::move(entry));
+    m_index.insert(key, m_lru.begin());
+    evictToLimit();
+}
+
+void TranslationMemory::evictToLimit() {
+    while (m_memoryUsage > m_memoryLimit && !m_lru.empty()) {
+        m_memoryUsage -= costOf(m_lru.back());
+        m_index.remove(m_lru.back().key);
+        m_lru.pop_back();
+        m_dirty = true;
+    }
+}
+
+bool TranslationMemory::load(const QString &path) {
+    clear();
+    m_dirty = false;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return !file.exists();
+
+    // One read, then parsing from memory
+    const QByteArray data = file.readAll();
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 count = 0;
+    in >> magic >> count;
+    if (magic != FILE_MAGIC)
+        return false;
+
+    m_index.reserve(int(qMin<quint32>(count, 1 << 20)));
+    // Stored oldest first, so inserting in file order restores the LRU order
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        quint64 key = 0;
+        QByteArray translation;
+        in >> key >> translation;
+        if (in.status() == QDataStream::Ok)
+            insertKey(key, std::move(translation));
+    }
+    m_dirty = false;
+    return in.status() == QDataStream::Ok;
+}
+
+bool TranslationMemory::save(const QString &path) {
+    if (!m_dirty)
+        return true;
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << FILE_MAGIC << quint32(m_lru.size());
+    for (auto it = m_lru.rbegin(); it != m_lru.rend(); ++it)
+        out << it->key << it->translation;
+    if (!file.commit())
+        return false;
+
+    m_dirty = false;
+    return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <list>
+
+// Persistent line-level memory of earlier translations, keyed by the
+// normalized source line and target language. Recurring UI strings ("OK",
+// menu labels, HUD text) are then filled in locally and only unknown lines
+// go to the model.
+//
+// Keys are stored as 64-bit digests rather than the source text, so an
+// entry costs little more than its translation. Least recently used lines
+// are evicted past the memory limit, and the file keeps that order.
+class TranslationMemory {
+public:
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+    };
+
+    explicit TranslationMemory(qint64 memoryLimitBytes = 4 * 1024 * 1024);
+
+    // Lines that are not worth remembering (too long, no letters) never hit
+    bool lookup(const QString &source, const QString &targetLanguage, QString *translation);
+    void insert(const QString &source, const QString &targetLanguage, const QString &translation);
+    void clear();
+
+    // Text with nothing to translate (numbers, punctuation) is shown as is
+    static bool needsTranslation(const QString &source);
+
+    void setMemoryLimit(qint64 bytes);
+    qint64 memoryUsage() const { return m_memoryUsage; }
+    int size() const { return int(m_index.size()); }
+    const Stats &stats() const { return m_stats; }
+
+    // Replaces the contents with the file's; a missing file leaves it empty
+    bool load(const QString &path);
+    // Writes only when something changed since the last load or save
+    bool save(const QString &path);
+    bool isDirty() const { return m_dirty; }
+
+private:
+    struct Entry {
+        quint64 key = 0;
+        QByteArray translation; // UTF-8
+    };
+
+    static quint64 keyOf(const QString &source, const QString &targetLanguage);
+    static qint64 costOf(const Entry &entry);
+    void insertKey(quint64 key, QByteArray translation);
+    void evictToLimit();
+
+    std::list<Entry> m_lru; // most recently used first
+    QHash<quint64, std::list<Entry>::iterator> m_index;
+    qint64 m_memoryLimit;
+    qint64 m_memoryUsage = 0;
+    bool m_dirty = false;
+    Stats m_stats;
+
+    // Sentences this long rarely recur verbatim
+    static constexpr int MAX_SOURCE_LENGTH = 160;
+};
@@ -1,6 +1,9 @@
 #include "TrayApp.h"
 #include "OpenAIBackend.h"
 #include "GeminiBackend.h"
+#include "HedgedService.h"
+#include "ImageTiler.h"
+#include "Trace.h"
 
 #include <QApplication>
 #include <QDialog>
@@ -9,10 +12,21 @@
 #include <QComboBox>
 #include <QKeySequenceEdit>
 #include <QSpinBox>
+#include <QCheckBox>
 #include <QDialogButtonBox>
-#include <QBuffer>
 #include <QMessageBox>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QSaveFile>
+#include <QTableWidget>
+#include <QVBoxLayout>
 #include <QIcon>
+#include <QStandardPaths>
+#include <QFontMetrics>
+
+#include <algorithm>
 
 TrayApp::TrayApp(QObject *parent)
     : QObject(parent)
@@ -21,9 +35,24 @@ TrayApp::TrayApp(QObject *parent)
     m_hotkeyManager = new HotkeyManager(this);
     m_regionSelector = new RegionSelector();
     m_overlayWindow = new OverlayWindow();
+    m_capturePipeline = new CapturePipeline(this);
+    m_scheduler = new RequestScheduler(this);
+    m_liveRegion = new LiveRegion(this);
+
+    m_memorySaveTimer = new QTimer(this);
+    m_memorySaveTimer->setSingleShot(true);
+    m_memorySaveTimer->setInterval(MEMORY_SAVE_DELAY_MS);
+    connect(m_memorySaveTimer, &QTimer::timeout, this, &TrayApp::saveTranslationMemory);
 }
 
 TrayApp::~TrayApp() {
+    saveTranslationMemory();
+
+    // TRANSIT_TRACE=<path> dumps the trace buffer on exit
+    const QString tracePath = qEnvironmentVariable("TRANSIT_TRACE");
+    QString error;
+    if (!tracePath.isEmpty() && !Trace::writeChromeJson(tracePath, &error))
+        qWarning("Could not write the trace to %s: %s", qPrintable(tracePath), qPrintable(error));
     if (m_trayIcon)
         m_trayIcon->setContextMenu(nullptr);
     delete m_trayMenu;
@@ -33,55 +62,566 @@ TrayApp::~TrayApp() {
 
 void TrayApp::initialize() {
     createTrayIcon();
+    applySchedulerSettings();
+    openTrafficArchive();
     createAIService();
     registerHotkey();
+    // Limits first, so loading is not trimmed to the defaults
+    applyCacheSettings();
+    if (!m_translationMemory.load(memoryPath()))
+        qWarning("Could not read the translation memory; starting empty.");
 
     // Connections
     connect(m_hotkeyManager, &HotkeyManager::hotkeyTriggered,
             this, &TrayApp::onHotkeyTriggered);
     connect(m_regionSelector, &RegionSelector::regionSelected,
             this, &TrayApp::onRegionSelected);
+    connect(m_regionSelector, &RegionSelector::selectionCancelled, this, [this]() {
+        if (m_pickingLive) {
+            m_pickingLive = false;
+            m_liveAction->setChecked(false);
+        }
+    });
+    connect(m_liveRegion, &LiveRegion::changed, this, &TrayApp::onLiveRegionChanged);
+    connect(m_capturePipeline, &CapturePipeline::composed,
+            this, &TrayApp::onCaptureComposed);
+    connect(m_capturePipeline, &CapturePipeline::encoded,
+            this, &TrayApp::onCaptureEncoded);
+    connect(m_capturePipeline, &CapturePipeline::recognized,
+            this, &TrayApp::onCaptureRecognized);
+    connect(m_scheduler, &RequestScheduler::jobDropped, this, [this](quint64 requestId) {
+        PendingRequest pending = m_pendingRequests.take(requestId);
+        if (pending.captureId != 0)
+            m_requestStats.recordCancel(pending.stats);
+        if (pending.tiles) {
+            ++pending.tiles->failed;
+            finishTile(pending);
+        }
+        finishLiveCapture(pending.captureId, false);
+    });
 
-    connect(m_overlayWindow, &OverlayWindow::dismissed,
-            this, [this]() {
-                if (m_aiService) m_aiService->cancel();
-            });
+    connect(m_overlayWindow, &OverlayWindow::dismissed, this, [this]() {
+        stopLive();
+        dropPendingRequests();
+    });
 
     m_overlayWindow->setFontSize(m_settings->overlayFontSize());
 }
 
 void TrayApp::onHotkeyTriggered() {
-    m_overlayWindow->dismiss();
+    m_hotkeyUs = Trace::now();
+    // A one-off capture takes the overlay over from a live region
+    stopLive();
+    m_pickingLive = false;
+    // Dismissing cancels outstanding requests; queued ones are kept
+    if (m_scheduler->mode() == RequestScheduler::Mode::Queue)
+        m_overlayWindow->hide();
+    else
+        m_overlayWindow->dismiss();
     m_regionSelector->start();
 }
 
-void TrayApp::onRegionSelected(const QRect &region, const QPixmap &screenshot) {
-    m_overlayWindow->showLoading(region);
+void TrayApp::onRegionSelected(const QRect &region, const RegionGrab &grab) {
+    if (m_pickingLive) {
+        m_pickingLive = false;
+        startLive(region);
+        return;
+    }
 
-    // Encode screenshot to PNG bytes
-    QByteArray imageData;
-    QBuffer buffer(&imageData);
-    buffer.open(QIODevice::WriteOnly);
-    screenshot.save(&buffer, "PNG");
-    buffer.close();
+    const qint64 selectedUs = Trace::now();
+    m_overlayWindow->showLoading(region);
 
     // Ensure AI service is current
     createAIService();
 
     if (!m_aiService) {
+        m_capturePipeline->cancel();
         m_overlayWindow->showError("No API key configured. Right-click tray icon → Settings.");
         return;
     }
 
-    m_aiService->translate(imageData, m_settings->targetLanguage());
+    // Unless captures are queued, a new one replaces whatever the previous
+    // one was still waiting for
+    const bool queue = m_scheduler->mode() == RequestScheduler::Mode::Queue;
+    if (!queue)
+        dropPendingRequests();
+
+    m_overlayCapture = m_capturePipeline->compose(region, grab, cacheContext(), !queue);
+
+    // The dwell ends where cutting the selection out of the frozen screens begins
+    const qint64 grabbedUs = selectedUs - qint64(grab.grabMs * 1000);
+    if (m_hotkeyUs >= 0)
+        Trace::record("select", m_overlayCapture, m_hotkeyUs, grabbedUs);
+    Trace::record("capture", m_overlayCapture, grabbedUs, selectedUs);
+    m_tracedCapture = m_overlayCapture;
+}
+
+CapturePipeline::CacheContext TrayApp::cacheContext() const {
+    CapturePipeline::CacheContext cache;
+    cache.targetLanguage = m_settings->targetLanguage();
+    if (m_settings->resultCacheSizeMB() > 0) {
+        cache.backend = m_aiService->name();
+        cache.model = m_settings->modelName(m_settings->activeBackend());
+        cache.withFingerprint = m_translationCache.similarityThreshold() > 0;
+    }
+    return cache;
+}
+
+void TrayApp::startLive(const QRect &region) {
+    createAIService();
+    if (!m_aiService) {
+        m_liveAction->setChecked(false);
+        m_overlayWindow->showLoading(region);
+        m_overlayWindow->showError("No API key configured. Right-click tray icon → Settings.");
+        return;
+    }
+
+    dropPendingRequests();
+    m_liveBlocks.clear();
+    m_liveCaptures.clear();
+    m_overlayCapture = 0;
+    m_overlayWindow->showLive(region);
+    m_liveRegion->setExcluded(m_overlayWindow->geometry());
+    m_liveRegion->start(region, m_settings->liveIntervalMs());
+}
+
+void TrayApp::stopLive() {
+    if (!m_liveRegion->isActive())
+        return;
+    m_liveRegion->stop();
+    m_liveCaptures.clear();
+    m_liveBlocks.clear();
+    m_liveAction->setChecked(false);
+}
+
+void TrayApp::onLiveRegionChanged(const QRect &area, const RegionGrab &grab) {
+    if (!m_aiService) {
+        m_liveRegion->captureFinished(false);
+        return;
+    }
+    // Never superseding: a one-off capture stops the live region instead
+    m_liveCaptures.insert(m_capturePipeline->compose(area, grab, cacheContext(), false));
+}
+
+void TrayApp::finishLiveCapture(quint64 captureId, bool ok) {
+    if (m_liveCaptures.remove(captureId))
+        m_liveRegion->captureFinished(ok);
+}
+
+void TrayApp::updateLive(const QRect &area, const QVector<TextBlock> &blocks) {
+    const QRect region = m_liveRegion->region();
+    const QRectF normalized(double(area.x() - region.x()) / region.width(),
+                            double(area.y() - region.y()) / region.height(),
+                            double(area.width()) / region.width(),
+                            double(area.height()) / region.height());
+
+    // The new blocks replace whatever was shown for that part of the region
+    m_liveBlocks.erase(std::remove_if(m_liveBlocks.begin(), m_liveBlocks.end(),
+                                      [&](const TextBlock &block) {
+                                          return normalized.contains(block.bbox.center());
+                                      }),
+                       m_liveBlocks.end());
+    m_liveBlocks += ImageTiler::mapBlocks(blocks, normalized);
+    std::stable_sort(m_liveBlocks.begin(), m_liveBlocks.end(),
+                     [](const TextBlock &a, const TextBlock &b) {
+                         return a.bbox.top() < b.bbox.top();
+                     });
+    m_overlayWindow->showResult(m_liveBlocks);
+    // The text layout may have grown the overlay
+    m_liveRegion->setExcluded(m_overlayWindow->geometry());
+}
+
+RequestScheduler::Options TrayApp::requestOptions(quint64 captureId) const {
+    // All requests of one capture share a batch, so only a newer capture
+    // supersedes them. Live updates yield to one-off captures.
+    RequestScheduler::Options options;
+    options.priority = m_liveCaptures.contains(captureId) ? RequestScheduler::Priority::Normal
+                                                          : RequestScheduler::Priority::Interactive;
+    options.batch = captureId;
+    return options;
+}
+
+void TrayApp::onCaptureComposed(const CapturePipeline::Handle &capture) {
+    if (!m_aiService)
+        return;
+
+    // Identical (or near-identical) pixels for the same language and model
+    // skip the round trip
+    if (!capture->cacheQuery.isNull()) {
+        QVector<TextBlock> cached;
+        if (m_translationCache.lookup(capture->cacheQuery, &cached)) {
+            showCaptureResult(capture->id, capture->region, cached);
+            return;
+        }
+    }
+
+    if (m_settings->localOcr() && LocalOcr::isAvailable()) {
+        m_capturePipeline->recognize(capture, m_settings->ocrLanguages());
+        return;
+    }
+    encodeCapture(capture);
+}
+
+void TrayApp::encodeCapture(const CapturePipeline::Handle &capture) {
+    // Downscale / recolour before upload. Glyph height is estimated from the
+    // UI font at the capture's device pixel ratio.
+    PreprocessOptions preprocess;
+    preprocess.targetTextHeight = m_settings->targetTextHeight();
+    preprocess.sourceTextHeight = QFontMetrics(QApplication::font()).height()
+                                  * capture->image.devicePixelRatio();
+    preprocess.colorMode = m_settings->imageColorMode();
+
+    // Tiled captures keep their resolution; each tile is within the limit.
+    // A live update is one request, so it can be tracked until it finishes.
+    const bool tiled = m_settings->tileLargeCaptures() && !m_liveCaptures.contains(capture->id);
+    preprocess.maxLongEdge = tiled ? 0 : MAX_UPLOAD_EDGE;
+
+    m_capturePipeline->encode(capture, preprocess,
+                              m_settings->encoderSettings(m_settings->activeBackend()),
+                              tiled ? TILE_EDGE : 0);
+}
+
+void TrayApp::onCaptureEncoded(const CapturePipeline::Handle &capture) {
+    if (!m_aiService)
+        return;
+
+    QVector<const EncodedImage *> images;
+    if (capture->tiles.isEmpty()) {
+        images.append(&capture->encoded);
+    } else {
+        for (const CapturePipeline::Tile &tile : capture->tiles)
+            images.append(&tile.encoded);
+    }
+    const RequestStats::Context stats = statsContext(capture->tiles.isEmpty() ? "vision"
+                                                                               : "tiled vision");
+    for (const EncodedImage *image : images) {
+        if (image->data.isEmpty()) {
+            if (capture->id == m_overlayCapture)
+                m_overlayWindow->showError("Could not encode the capture.");
+            finishLiveCapture(capture->id, false);
+            return;
+        }
+        m_requestStats.recordEncode(stats, image->encodeMs, image->data.size());
+    }
+
+    const RequestScheduler::Options options = requestOptions(capture->id);
+    if (!capture->tiles.isEmpty()) {
+        sendTiles(capture, options);
+        return;
+    }
+
+    quint64 requestId = m_aiService->translate(capture->encoded, capture->targetLanguage, options);
+    if (requestId == 0) {
+        if (capture->id == m_overlayCapture)
+            m_overlayWindow->showError("Could not start the request.");
+        finishLiveCapture(capture->id, false);
+        return;
+    }
+    PendingRequest pending{capture->id, capture->region, capture->cacheQuery};
+    pending.clock = capture->clock;
+    pending.stats = statsContext(pending.path);
+    m_pendingRequests.insert(requestId, pending);
 }
 
-void TrayApp::onTranslationReady(const QVector<TextBlock> &blocks) {
+void TrayApp::onCaptureRecognized(const CapturePipeline::Handle &capture) {
+    if (!m_aiService)
+        return;
+
+    // Nothing legible to the OCR engine (stylised text, say): the vision
+    // model may still read it
+    if (capture->lines.isEmpty()) {
+        encodeCapture(capture);
+        return;
+    }
+
+    PendingRequest pending{capture->id, capture->region, capture->cacheQuery};
+    pending.path = "local OCR";
+    pending.clock = capture->clock;
+    pending.stats = statsContext(pending.path);
+    pending.lines = capture->lines;
+    pending.targetLanguage = capture->targetLanguage;
+
+    // Lines translated before are filled in here; only the rest are sent
+    QVector<TextBlock> unknown;
+    const bool useMemory = m_settings->translationMemorySizeMB() > 0;
+    for (int i = 0; i < pending.lines.size(); ++i) {
+        TextBlock &line = pending.lines[i];
+        if (!TranslationMemory::needsTranslation(line.text))
+            continue;
+        QString translation;
+        if (useMemory && m_translationMemory.lookup(line.text, capture->targetLanguage,
+                                                    &translation)) {
+            line.text = translation;
+        } else {
+            pending.sentLines.append(i);
+            unknown.append(line);
+        }
+    }
+
+    if (unknown.isEmpty()) {
+        recordResult(pending);
+        if (!capture->cacheQuery.isNull())
+            m_translationCache.insert(capture->cacheQuery, pending.lines);
+        showCaptureResult(capture->id, capture->region, pending.lines);
+        return;
+    }
+
+    quint64 requestId = m_aiService->translateLines(unknown, capture->targetLanguage,
+                                                    requestOptions(capture->id));
+    if (requestId == 0) {
+        if (capture->id == m_overlayCapture)
+            m_overlayWindow->showError("Could not start the request.");
+        finishLiveCapture(capture->id, false);
+        return;
+    }
+    m_pendingRequests.insert(requestId, pending);
+}
+
+QVector<TextBlock> TrayApp::fillLines(const PendingRequest &pending,
+                                      const QVector<TextBlock> &blocks) {
+    QVector<TextBlock> lines = pending.lines;
+    const int count = int(qMin(blocks.size(), pending.sentLines.size()));
+    // A cut-off reply keeps the source text for lines it never reached,
+    // which must not be remembered as their translation
+    const bool remember = !pending.truncated && m_settings->translationMemorySizeMB() > 0;
+    for (int i = 0; i < count; ++i) {
+        TextBlock &line = lines[pending.sentLines[i]];
+        if (remember)
+            m_translationMemory.insert(line.text, pending.targetLanguage, blocks[i].text);
+        line.text = blocks[i].text;
+    }
+    if (m_translationMemory.isDirty() && !m_memorySaveTimer->isActive())
+        m_memorySaveTimer->start();
+    return lines;
+}
+
+void TrayApp::sendTiles(const CapturePipeline::Handle &capture,
+                        const RequestScheduler::Options &options) {
+    auto group = std::make_shared<TileGroup>();
+    group->blocks.resize(capture->tiles.size());
+
+    // Tiles share the capture's batch, so they run side by side
+    for (int i = 0; i < capture->tiles.size(); ++i) {
+        const CapturePipeline::Tile &tile = capture->tiles[i];
+        group->areas.append(tile.area);
+
+        quint64 requestId = m_aiService->translate(tile.encoded, capture->targetLanguage, options);
+        if (requestId == 0) {
+            ++group->failed;
+            continue;
+        }
+        PendingRequest pending{capture->id, capture->region, capture->cacheQuery};
+        pending.tiles = group;
+        pending.tile = i;
+        pending.path = "tiled vision";
+        pending.clock = capture->clock;
+        pending.stats = statsContext(pending.path);
+        m_pendingRequests.insert(requestId, pending);
+        ++group->remaining;
+    }
+
+    if (group->remaining == 0 && capture->id == m_overlayCapture)
+        m_overlayWindow->showError("Could not start the request.");
+}
+
+void TrayApp::finishTile(const PendingRequest &pending) {
+    TileGroup &group = *pending.tiles;
+    if (--group.remaining > 0) {
+        // Show what the finished tiles have so far
+        if (pending.captureId == m_overlayCapture)
+            showCaptureResult(pending.captureId, pending.region, ImageTiler::merge(group.blocks));
+        return;
+    }
+
+    if (group.failed == group.blocks.size()) {
+        if (pending.captureId == m_overlayCapture)
+            m_overlayWindow->showError(group.error.isEmpty() ? "Request failed." : group.error);
+        else
+            qWarning("Queued capture failed: %s", qPrintable(group.error));
+        return;
+    }
+
+    recordResult(pending);
+
+    // Duplicates read in the overlap zones go before the overlay sees them
+    QVector<TextBlock> merged = ImageTiler::merge(group.blocks);
+    bool complete = group.failed == 0 && !group.truncated;
+    if (!pending.cacheQuery.isNull() && complete)
+        m_translationCache.insert(pending.cacheQuery, merged);
+    showCaptureResult(pending.captureId, pending.region, merged);
+
+    if (!complete && pending.captureId == m_overlayCapture) {
+        m_trayIcon->showMessage("TransIt", "Part of the capture could not be translated.",
+                                QSystemTrayIcon::Warning, 4000);
+    }
+}
+
+void TrayApp::onBlocksReceived(quint64 requestId, const QVector<TextBlock> &blocks) {
+    // Live updates are merged only once complete
+    auto it = m_pendingRequests.constFind(requestId);
+    if (it == m_pendingRequests.constEnd() || it->captureId != m_overlayCapture)
+        return;
+    if (it->tiles)
+        m_overlayWindow->appendBlocks(ImageTiler::mapBlocks(blocks, it->tiles->areas[it->tile]));
+    else
+        m_overlayWindow->appendBlocks(blocks);
+}
+
+void TrayApp::onTranslationReady(quint64 requestId, const QVector<TextBlock> &blocks) {
+    PendingRequest pending = m_pendingRequests.take(requestId);
+    if (pending.captureId == 0)
+        return;
+
+    m_requestStats.recordSuccess(pending.stats);
+    if (pending.tiles) {
+        pending.tiles->blocks[pending.tile] =
+            ImageTiler::mapBlocks(blocks, pending.tiles->areas[pending.tile]);
+        pending.tiles->truncated |= pending.truncated;
+        finishTile(pending);
+        return;
+    }
+
+    recordResult(pending);
+
+    const QVector<TextBlock> result = pending.sentLines.isEmpty()
+        ? blocks : fillLines(pending, blocks);
+    // A partial result must not answer later captures of the same text
+    if (!pending.cacheQuery.isNull() && !pending.truncated)
+        m_translationCache.insert(pending.cacheQuery, result);
+    showCaptureResult(pending.captureId, pending.region, result);
+
+    if (pending.truncated && pending.captureId == m_overlayCapture) {
+        m_trayIcon->showMessage("TransIt", QString("The reply was cut off; showing the %1 "
+                                                   "blocks that arrived.").arg(blocks.size()),
+                                QSystemTrayIcon::Warning, 4000);
+    }
+}
+
+void TrayApp::onTranslationTruncated(quint64 requestId) {
+    auto it = m_pendingRequests.find(requestId);
+    if (it != m_pendingRequests.end())
+        it->truncated = true;
+}
+
+void TrayApp::onTranslationTimedOut(quint64 requestId) {
+    auto it = m_pendingRequests.find(requestId);
+    if (it != m_pendingRequests.end())
+        it->timedOut = true;
+}
+
+void TrayApp::onFirstByteTimed(quint64 requestId, double ms) {
+    auto it = m_pendingRequests.constFind(requestId);
+    if (it != m_pendingRequests.constEnd())
+        m_requestStats.recordFirstByte(it->stats, ms);
+}
+
+void TrayApp::onRequestSent(quint64 requestId, qint64 bytes) {
+    auto it = m_pendingRequests.constFind(requestId);
+    if (it != m_pendingRequests.constEnd())
+        m_requestStats.recordRequestBytes(it->stats, bytes);
+}
+
+void TrayApp::onTranslationFailed(quint64 requestId, const QString &error) {
+    PendingRequest pending = m_pendingRequests.take(requestId);
+    if (pending.captureId == 0)
+        return;
+
+    m_requestStats.recordFailure(pending.stats, pending.timedOut);
+    if (pending.tiles) {
+        ++pending.tiles->failed;
+        pending.tiles->error = error;
+        finishTile(pending);
+        return;
+    }
+
+    finishLiveCapture(pending.captureId, false);
+
+    // A queued capture failing behind the one on screen is only logged
+    if (pending.captureId == m_overlayCapture)
+        m_overlayWindow->showError(error);
+    else
+        qWarning("Queued capture failed: %s", qPrintable(error));
+}
+
+void TrayApp::recordResult(const PendingRequest &pending) {
+    m_requestStats.recordEndToEnd(pending.stats, double(pending.clock.elapsed()));
+    updateTrayTooltip(pending.stats);
+}
+
+RequestStats::Context TrayApp::statsContext(const char *path) const {
+    RequestStats::Context context;
+    const Settings::Backend backend = m_settings->activeBackend();
+    context.backend = m_hedged ? m_aiService->name() + " (hedged)" : m_aiService->name();
+    context.model = m_settings->modelName(backend);
+    context.transport = m_settings->transport() == AIService::Transport::QtNetwork ? "qt" : "curl";
+    if (qstrcmp(path, "local OCR") == 0) {
+        context.encoder = "text";
+        return context;
+    }
+
+    const EncoderSettings encoder = m_settings->encoderSettings(backend);
+    switch (encoder.format) {
+    case EncoderSettings::Format::Png:        context.encoder = "png"; break;
+    case EncoderSettings::Format::PalettePng: context.encoder = "png8"; break;
+    case EncoderSettings::Format::Jpeg:       context.encoder = "jpeg"; break;
+    case EncoderSettings::Format::WebP:       context.encoder = "webp"; break;
+    }
+    if (encoder.quality >= 0)
+        context.encoder += QString(" q%1").arg(encoder.quality);
+    if (qstrcmp(path, "tiled vision") == 0)
+        context.encoder += " tiled";
+    return context;
+}
+
+void TrayApp::updateTrayTooltip(const RequestStats::Context &context) {
+    const RequestStats::Summary s = m_requestStats.summary(context);
+    m_trayIcon->setToolTip(QString("TransIt - Screen Translator\n%1\n"
+                                   "p50 %2 s, p95 %3 s, p99 %4 s (%5 captures)")
+                               .arg(context.label())
+                               .arg(s.endToEnd.p50 / 1000, 0, 'f', 1)
+                               .arg(s.endToEnd.p95 / 1000, 0, 'f', 1)
+                               .arg(s.endToEnd.p99 / 1000, 0, 'f', 1)
+                               .arg(s.endToEnd.samples));
+}
+
+void TrayApp::showCaptureResult(quint64 captureId, const QRect &region,
+                                const QVector<TextBlock> &blocks) {
+    if (m_liveCaptures.contains(captureId)) {
+        m_overlayWindow->traceNextResult(captureId);
+        updateLive(region, blocks);
+        finishLiveCapture(captureId, true);
+        return;
+    }
+
+    // Queued captures can finish out of order; never replace a newer result
+    if (captureId < m_shownCapture)
+        return;
+
+    if (captureId != m_overlayCapture || !m_overlayWindow->isVisible()) {
+        m_overlayWindow->showLoading(region);
+        m_overlayCapture = captureId;
+    }
+    m_shownCapture = captureId;
+    m_overlayWindow->traceNextResult(captureId,
+                                     captureId == m_tracedCapture ? m_hotkeyUs : -1);
     m_overlayWindow->showResult(blocks);
 }
 
-void TrayApp::onTranslationFailed(const QString &error) {
-    m_overlayWindow->showError(error);
+void TrayApp::applySchedulerSettings() {
+    m_scheduler->setMode(m_settings->queueCaptures() ? RequestScheduler::Mode::Queue
+                                                     : RequestScheduler::Mode::Supersede);
+    // Every tile of a capture should be in flight at once
+    m_scheduler->setMaxConcurrent(m_settings->tileLargeCaptures()
+                                  ? CapturePipeline::MAX_TILES : DEFAULT_CONCURRENT_REQUESTS);
+}
+
+void TrayApp::dropPendingRequests() {
+    m_capturePipeline->cancel();
+    if (m_aiService)
+        m_aiService->cancel();
+    for (const PendingRequest &pending : std::as_const(m_pendingRequests))
+        m_requestStats.recordCancel(pending.stats);
+    m_pendingRequests.clear();
 }
 
 void TrayApp::createTrayIcon() {
@@ -92,9 +632,28 @@ void TrayApp::createTrayIcon() {
 
     m_trayMenu = new QMenu();
 
+    m_liveAction = m_trayMenu->addAction("Live Region");
+    m_liveAction->setCheckable(true);
+    m_liveAction->setToolTip("Keep translating a region as its text changes");
+    connect(m_liveAction, &QAction::triggered, this, [this](bool checked) {
+        if (checked) {
+            m_overlayWindow->dismiss();
+            m_pickingLive = true;
+            m_regionSelector->start();
+        } else {
+            m_overlayWindow->dismiss();
+        }
+    });
+
+    QAction *traceAction = m_trayMenu->addAction("Save Trace...");
+    connect(traceAction, &QAction::triggered, this, &TrayApp::saveTrace);
+
     QAction *settingsAction = m_trayMenu->addAction("Settings...");
     connect(settingsAction, &QAction::triggered, this, &TrayApp::showSettingsDialog);
 
+    QAction *statsAction = m_trayMenu->addAction("Statistics...");
+    connect(statsAction, &QAction::triggered, this, &TrayApp::showStatsDialog);
+
     m_trayMenu->addSeparator();
 
     QAction *quitAction = m_trayMenu->addAction("Quit");
@@ -108,37 +667,146 @@ void TrayApp::createTrayIcon() {
         QSystemTrayIcon::Information, 3000);
 }
 
+void TrayApp::saveTrace() {
+    QString path = QFileDialog::getSaveFileName(
+        nullptr, "Save Trace", "transit-trace.json",
+        "Chrome Trace (*.json);;All Files (*)");
+    if (path.isEmpty())
+        return;
+
+    QString error;
+    if (!Trace::writeChromeJson(path, &error))
+        QMessageBox::warning(nullptr, "TransIt", "Could not save the trace: " + error);
+}
+
 void TrayApp::createAIService() {
-    if (m_aiService) {
+    Settings::Backend backend = m_settings->activeBackend();
+    QString apiKey = m_settings->apiKey(backend);
+
+    Settings::Backend hedgeBackend = m_settings->hedgeBackend();
+    bool hedge = m_settings->hedgeRequests() && !m_settings->apiKey(hedgeBackend).isEmpty();
+    QString hedgeModel = m_settings->hedgeModel();
+    if (hedgeModel.isEmpty())
+        hedgeModel = m_settings->modelName(hedgeBackend);
+    QStringList hedgeConfig;
+    if (hedge) {
+        hedgeConfig = {QString::number(int(backend)), apiKey, m_settings->baseUrl(backend),
+                       m_settings->modelName(backend), QString::number(int(hedgeBackend)),
+                       m_settings->apiKey(hedgeBackend), m_settings->baseUrl(hedgeBackend),
+                       hedgeModel, QString::number(m_settings->hedgeDelayMs())};
+    }
+
+    // Keep the existing backend (and its warm connection) while the backend
+    // type stays the same; it rebuilds its session itself if URL or key change.
+    // A hedged pair is kept until anything it was built from changes.
+    if (m_aiService && (apiKey.isEmpty() || backend != m_aiBackend || hedge != m_hedged
+                        || hedgeConfig != m_hedgeConfig)) {
         m_aiService->cancel();
+        m_pendingRequests.clear();
         disconnect(m_aiService, nullptr, this, nullptr);
         m_aiService->deleteLater();
         m_aiService = nullptr;
     }
 
-    Settings::Backend backend = m_settings->activeBackend();
-    QString apiKey = m_settings->apiKey(backend);
-
     if (apiKey.isEmpty())
         return;
 
+    if (m_aiService) {
+        m_aiService->reconfigure(apiKey, m_settings->baseUrl(backend),
+                                 m_settings->modelName(backend));
+        if (auto *hedged = qobject_cast<HedgedService *>(m_aiService)) {
+            configureBackend(hedged->primary(), backend);
+            configureBackend(hedged->secondary(), hedgeBackend);
+        } else {
+            configureBackend(m_aiService, backend);
+        }
+        return;
+    }
+
+    m_aiBackend = backend;
+    m_hedged = hedge;
+    m_hedgeConfig = hedgeConfig;
+    m_aiService = createBackend(backend, m_settings->modelName(backend));
+    if (m_aiService && hedge) {
+        // Races are scored per backend and model, so a rebuilt pair keeps
+        // the record of whichever half stayed the same
+        m_aiService = new HedgedService(m_aiService, m_settings->modelName(backend),
+                                        createBackend(hedgeBackend, hedgeModel), hedgeModel,
+                                        m_settings->hedgeDelayMs(), &m_requestStats, this);
+        m_aiService->setScheduler(m_scheduler);
+    }
+
+    if (m_aiService) {
+        connect(m_aiService, &AIService::blocksReceived,
+                this, &TrayApp::onBlocksReceived);
+        connect(m_aiService, &AIService::translationReady,
+                this, &TrayApp::onTranslationReady);
+        connect(m_aiService, &AIService::translationTruncated,
+                this, &TrayApp::onTranslationTruncated);
+        connect(m_aiService, &AIService::translationFailed,
+                this, &TrayApp::onTranslationFailed);
+        connect(m_aiService, &AIService::translationTimedOut,
+                this, &TrayApp::onTranslationTimedOut);
+        connect(m_aiService, &AIService::firstByteTimed,
+                this, &TrayApp::onFirstByteTimed);
+        connect(m_aiService, &AIService::requestSent,
+                this, &TrayApp::onRequestSent);
+    }
+}
+
+AIService *TrayApp::createBackend(Settings::Backend backend, const QString &modelName) {
+    QString apiKey = m_settings->apiKey(backend);
     QString baseUrl = m_settings->baseUrl(backend);
-    QString modelName = m_settings->modelName(backend);
 
+    AIService *service = nullptr;
     switch (backend) {
         case Settings::Backend::OpenAI:
-            m_aiService = new OpenAIBackend(apiKey, baseUrl, modelName, this);
+            service = new OpenAIBackend(apiKey, baseUrl, modelName, this);
             break;
         case Settings::Backend::Gemini:
-            m_aiService = new GeminiBackend(apiKey, baseUrl, modelName, this);
+            service = new GeminiBackend(apiKey, baseUrl, modelName, this);
             break;
     }
+    if (service) {
+        service->setScheduler(m_scheduler);
+        configureBackend(service, backend);
+    }
+    return service;
+}
 
-    if (m_aiService) {
-        connect(m_aiService, &AIService::translationReady,
-                this, &TrayApp::onTranslationReady);
-        connect(m_aiService, &AIService::translationFailed,
-                this, &TrayApp::onTranslationFailed);
+void TrayApp::configureBackend(AIService *service, Settings::Backend backend) {
+    service->setTransport(m_settings->transport());
+    service->setStreamingEnabled(m_settings->streamResponses(backend));
+    service->setContinueTruncated(m_settings->continueTruncated());
+    service->setRecorder(m_trafficRecorder);
+    service->setReplay(m_trafficReplay);
+}
+
+// TRANSIT_RECORD=<path> appends all provider traffic to an archive.
+// TRANSIT_REPLAY=<path> serves responses from one instead of the network,
+// scaled by TRANSIT_REPLAY_SPEED (1 by default, 0 for no delays).
+void TrayApp::openTrafficArchive() {
+    QString error;
+    const QString replayPath = qEnvironmentVariable("TRANSIT_REPLAY");
+    if (!replayPath.isEmpty()) {
+        QVector<TrafficArchive::Round> rounds;
+        if (TrafficArchive::load(replayPath, &rounds, &error)) {
+            bool ok = false;
+            const double speed = qEnvironmentVariable("TRANSIT_REPLAY_SPEED").toDouble(&ok);
+            m_trafficReplay = std::make_shared<TrafficArchive::Replay>(std::move(rounds), ok ? speed : 1.0);
+            qInfo("Replaying %d recorded rounds from %s", m_trafficReplay->size(), qPrintable(replayPath));
+        } else {
+            qWarning("Could not read %s: %s", qPrintable(replayPath), qPrintable(error));
+        }
+    }
+
+    const QString recordPath = qEnvironmentVariable("TRANSIT_RECORD");
+    if (!recordPath.isEmpty()) {
+        auto recorder = std::make_shared<TrafficArchive::Recorder>();
+        if (recorder->open(recordPath, &error))
+            m_trafficRecorder = std::move(recorder);
+        else
+            qWarning("Could not open %s: %s", qPrintable(recordPath), qPrintable(error));
     }
 }
 
@@ -149,6 +817,136 @@ void TrayApp::registerHotkey() {
     }
 }
 
+void TrayApp::applyCacheSettings() {
+    m_translationCache.setMemoryLimit(qint64(m_settings->resultCacheSizeMB()) * 1024 * 1024);
+    m_translationCache.setSimilarityThreshold(m_settings->nearMatchThreshold());
+
+    QString diskDir;
+    if (m_settings->resultCacheSizeMB() > 0 && m_settings->diskCacheEnabled())
+        diskDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/translations";
+    m_translationCache.setDiskDirectory(diskDir, DISK_CACHE_LIMIT);
+
+    m_translationMemory.setMemoryLimit(
+        qint64(m_settings->translationMemorySizeMB()) * 1024 * 1024);
+}
+
+QString TrayApp::memoryPath() const {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+        + "/translation-memory.ttm";
+}
+
+void TrayApp::saveTranslationMemory() {
+    m_memorySaveTimer->stop();
+    if (m_translationMemory.isDirty() && !m_translationMemory.save(memoryPath()))
+        qWarning("Could not write the translation memory.");
+}
+
+void TrayApp::showStatsDialog() {
+    QDialog dialog;
+    dialog.setWindowTitle("TransIt Statistics");
+    dialog.setMinimumSize(1180, 260);
+    auto *layout = new QVBoxLayout(&dialog);
+
+    const QStringList headers = {
+        "Backend", "Model", "Encoder", "Transport", "OK", "Errors", "Timeouts", "Cancelled",
+        "End-to-end p50", "p95", "p99", "First byte p50", "p95", "p99",
+        "Encode p50", "p95", "Image avg", "Upload avg"
+    };
+    auto *table = new QTableWidget(0, int(headers.size()));
+    table->setHorizontalHeaderLabels(headers);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->verticalHeader()->hide();
+    layout->addWidget(table);
+    auto *cacheLabel = new QLabel();
+    layout->addWidget(cacheLabel);
+
+    const QStringList hedgeHeaders = {
+        "Hedged backend", "Model", "Races", "Wins", "Win rate", "Saved"
+    };
+    auto *hedgeTable = new QTableWidget(0, int(hedgeHeaders.size()));
+    hedgeTable->setHorizontalHeaderLabels(hedgeHeaders);
+    hedgeTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    hedgeTable->verticalHeader()->hide();
+    layout->addWidget(hedgeTable);
+
+    auto fill = [this, table, cacheLabel, hedgeTable]() {
+        const QVector<RequestStats::Summary> summaries = m_requestStats.summaries();
+        table->setRowCount(int(summaries.size()));
+        auto ms = [](const RequestStats::Percentiles &p, double value) {
+            return p.samples == 0 ? QString("-") : QString("%1 ms").arg(qRound(value));
+        };
+        auto kb = [](quint64 count, quint64 bytes) {
+            return count == 0 ? QString("-")
+                              : QString("%1 KB").arg(double(bytes) / count / 1024, 0, 'f', 1);
+        };
+        for (int row = 0; row < summaries.size(); ++row) {
+            const RequestStats::Summary &s = summaries[row];
+            const QStringList cells = {
+                s.context.backend, s.context.model, s.context.encoder, s.context.transport,
+                QString::number(s.succeeded), QString::number(s.errors),
+                QString::number(s.timeouts), QString::number(s.cancelled),
+                ms(s.endToEnd, s.endToEnd.p50), ms(s.endToEnd, s.endToEnd.p95),
+                ms(s.endToEnd, s.endToEnd.p99),
+                ms(s.firstByte, s.firstByte.p50), ms(s.firstByte, s.firstByte.p95),
+                ms(s.firstByte, s.firstByte.p99),
+                ms(s.encode, s.encode.p50), ms(s.encode, s.encode.p95),
+                kb(s.images, s.imageBytes), kb(s.requests, s.requestBytes)
+            };
+            for (int column = 0; column < cells.size(); ++column)
+                table->setItem(row, column, new QTableWidgetItem(cells[column]));
+        }
+        table->resizeColumnsToContents();
+
+        const TranslationCache::Stats &cache = m_translationCache.stats();
+        cacheLabel->setText(QString("Result cache: %1 exact hits, %2 near hits, %3 misses")
+                                .arg(cache.exactHits).arg(cache.nearHits).arg(cache.misses));
+
+        const QVector<RequestStats::HedgeScore> scores = m_requestStats.hedgeScores();
+        hedgeTable->setVisible(!scores.isEmpty());
+        hedgeTable->setRowCount(int(scores.size()));
+        for (int row = 0; row < scores.size(); ++row) {
+            const RequestStats::HedgeScore &h = scores[row];
+            const QStringList cells = {
+                h.backend, h.model, QString::number(h.races), QString::number(h.wins),
+                h.races == 0 ? QString("-")
+                             : QString("%1%").arg(qRound(100.0 * h.wins / h.races)),
+                QString("%1 ms").arg(qRound(h.savedMs))
+            };
+            for (int column = 0; column < cells.size(); ++column)
+                hedgeTable->setItem(row, column, new QTableWidgetItem(cells[column]));
+        }
+        hedgeTable->resizeColumnsToContents();
+    };
+    fill();
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    QPushButton *exportButton = buttons->addButton("Export JSON...",
+                                                   QDialogButtonBox::ActionRole);
+    QPushButton *resetButton = buttons->addButton("Reset", QDialogButtonBox::ResetRole);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    connect(exportButton, &QPushButton::clicked, &dialog, [this, &dialog]() {
+        QString path = QFileDialog::getSaveFileName(
+            &dialog, "Export Statistics", "transit-stats.json",
+            "JSON Files (*.json);;All Files (*)");
+        if (path.isEmpty())
+            return;
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(m_requestStats.toJson(m_translationCache.stats())) < 0
+            || !file.commit()) {
+            QMessageBox::warning(&dialog, "TransIt",
+                                 "Could not export the statistics: " + file.errorString());
+        }
+    });
+    connect(resetButton, &QPushButton::clicked, &dialog, [this, fill]() {
+        m_requestStats.clear();
+        m_translationCache.resetStats();
+        fill();
+    });
+    layout->addWidget(buttons);
+
+    dialog.exec();
+}
+
 void TrayApp::showSettingsDialog() {
     QDialog dialog;
     dialog.setWindowTitle("TransIt Settings");
@@ -156,6 +954,31 @@ void TrayApp::showSettingsDialog() {
 
     auto *layout = new QFormLayout(&dialog);
 
+    auto makeFormatCombo = [](const EncoderSettings &encoder) {
+        auto *combo = new QComboBox();
+        combo->addItem("PNG", static_cast<int>(EncoderSettings::Format::Png));
+        combo->addItem("PNG (256 colors)", static_cast<int>(EncoderSettings::Format::PalettePng));
+        combo->addItem("JPEG", static_cast<int>(EncoderSettings::Format::Jpeg));
+        if (isEncoderAvailable(EncoderSettings::Format::WebP))
+            combo->addItem("WebP", static_cast<int>(EncoderSettings::Format::WebP));
+        combo->setCurrentIndex(qMax(0, combo->findData(static_cast<int>(encoder.format))));
+        return combo;
+    };
+    auto makeQualitySpin = [](const EncoderSettings &encoder) {
+        auto *spin = new QSpinBox();
+        spin->setRange(-1, 100);
+        spin->setSpecialValueText("Default");
+        spin->setToolTip("JPEG/WebP: 0-100 quality. PNG: 0 = smallest, 100 = uncompressed.");
+        spin->setValue(encoder.quality);
+        return spin;
+    };
+    auto encoderFrom = [](QComboBox *combo, QSpinBox *spin) {
+        EncoderSettings encoder;
+        encoder.format = static_cast<EncoderSettings::Format>(combo->currentData().toInt());
+        encoder.quality = spin->value();
+        return encoder;
+    };
+
     // Backend selection
     auto *backendCombo = new QComboBox();
     backendCombo->addItem("OpenAI-Compatible", static_cast<int>(Settings::Backend::OpenAI));
@@ -176,6 +999,16 @@ void TrayApp::showSettingsDialog() {
     openaiKeyEdit->setPlaceholderText("sk-...");
     layout->addRow("OpenAI API Key:", openaiKeyEdit);
 
+    auto *openaiStreamCheck = new QCheckBox("Show blocks as they arrive");
+    openaiStreamCheck->setChecked(m_settings->streamResponses(Settings::Backend::OpenAI));
+    layout->addRow("OpenAI Streaming:", openaiStreamCheck);
+
+    EncoderSettings openaiEncoder = m_settings->encoderSettings(Settings::Backend::OpenAI);
+    auto *openaiFormatCombo = makeFormatCombo(openaiEncoder);
+    layout->addRow("OpenAI Image Format:", openaiFormatCombo);
+    auto *openaiQualitySpin = makeQualitySpin(openaiEncoder);
+    layout->addRow("OpenAI Image Quality:", openaiQualitySpin);
+
     auto *geminiUrlEdit = new QLineEdit(m_settings->baseUrl(Settings::Backend::Gemini));
     geminiUrlEdit->setPlaceholderText("https://generativelanguage.googleapis.com");
     layout->addRow("Gemini Base URL:", geminiUrlEdit);
@@ -189,6 +1022,40 @@ void TrayApp::showSettingsDialog() {
     geminiKeyEdit->setPlaceholderText("AI...");
     layout->addRow("Gemini API Key:", geminiKeyEdit);
 
+    auto *geminiStreamCheck = new QCheckBox("Show blocks as they arrive");
+    geminiStreamCheck->setChecked(m_settings->streamResponses(Settings::Backend::Gemini));
+    layout->addRow("Gemini Streaming:", geminiStreamCheck);
+
+    EncoderSettings geminiEncoder = m_settings->encoderSettings(Settings::Backend::Gemini);
+    auto *geminiFormatCombo = makeFormatCombo(geminiEncoder);
+    layout->addRow("Gemini Image Format:", geminiFormatCombo);
+    auto *geminiQualitySpin = makeQualitySpin(geminiEncoder);
+    layout->addRow("Gemini Image Quality:", geminiQualitySpin);
+
+    // Hedging
+    auto *hedgeCheck = new QCheckBox("Also send slow requests to a second backend");
+    hedgeCheck->setChecked(m_settings->hedgeRequests());
+    layout->addRow("Hedge Requests:", hedgeCheck);
+
+    auto *hedgeBackendCombo = new QComboBox();
+    hedgeBackendCombo->addItem("OpenAI-Compatible", static_cast<int>(Settings::Backend::OpenAI));
+    hedgeBackendCombo->addItem("Google Gemini", static_cast<int>(Settings::Backend::Gemini));
+    hedgeBackendCombo->setCurrentIndex(static_cast<int>(m_settings->hedgeBackend()));
+    layout->addRow("Hedge Backend:", hedgeBackendCombo);
+
+    auto *hedgeModelEdit = new QLineEdit(m_settings->hedgeModel());
+    hedgeModelEdit->setPlaceholderText("Same as the backend's model");
+    layout->addRow("Hedge Model:", hedgeModelEdit);
+
+    auto *hedgeDelaySpin = new QSpinBox();
+    hedgeDelaySpin->setRange(0, 30000);
+    hedgeDelaySpin->setSingleStep(250);
+    hedgeDelaySpin->setSuffix(" ms");
+    hedgeDelaySpin->setSpecialValueText("At once");
+    hedgeDelaySpin->setToolTip("How long a request may run before the hedge backend is asked too");
+    hedgeDelaySpin->setValue(m_settings->hedgeDelayMs());
+    layout->addRow("Hedge Delay:", hedgeDelaySpin);
+
     // Target language
     auto *langCombo = new QComboBox();
     langCombo->setEditable(true);
@@ -211,6 +1078,96 @@ void TrayApp::showSettingsDialog() {
     fontSizeSpin->setValue(m_settings->overlayFontSize());
     layout->addRow("Overlay Font Size:", fontSizeSpin);
 
+    // Capture preprocessing
+    auto *textHeightSpin = new QSpinBox();
+    textHeightSpin->setRange(0, 64);
+    textHeightSpin->setSuffix(" px");
+    textHeightSpin->setSpecialValueText("Original size");
+    textHeightSpin->setToolTip("Downscale captures so that text is about this tall before upload");
+    textHeightSpin->setValue(m_settings->targetTextHeight());
+    layout->addRow("Upload Text Height:", textHeightSpin);
+
+    auto *colorModeCombo = new QComboBox();
+    colorModeCombo->addItem("Color", static_cast<int>(PreprocessOptions::ColorMode::Color));
+    colorModeCombo->addItem("Grayscale", static_cast<int>(PreprocessOptions::ColorMode::Grayscale));
+    colorModeCombo->addItem("Grayscale + Contrast", static_cast<int>(PreprocessOptions::ColorMode::Contrast));
+    colorModeCombo->addItem("Black & White", static_cast<int>(PreprocessOptions::ColorMode::Binary));
+    colorModeCombo->setCurrentIndex(static_cast<int>(m_settings->imageColorMode()));
+    layout->addRow("Upload Colors:", colorModeCombo);
+
+    auto *tileCheck = new QCheckBox("Split into tiles translated in parallel");
+    tileCheck->setToolTip("Keeps small text legible in full-page captures");
+    tileCheck->setChecked(m_settings->tileLargeCaptures());
+    layout->addRow("Large Captures:", tileCheck);
+
+    auto *ocrCheck = new QCheckBox("Read text locally and send only the text");
+    ocrCheck->setChecked(m_settings->localOcr() && LocalOcr::isAvailable());
+    ocrCheck->setEnabled(LocalOcr::isAvailable());
+    if (!LocalOcr::isAvailable())
+        ocrCheck->setToolTip("This build has no OCR engine (TRANSIT_WITH_TESSERACT)");
+    layout->addRow("Local OCR:", ocrCheck);
+
+    auto *ocrLanguagesEdit = new QLineEdit(m_settings->ocrLanguages());
+    ocrLanguagesEdit->setPlaceholderText("eng+jpn");
+    ocrLanguagesEdit->setToolTip("Tesseract language codes of the text being captured");
+    ocrLanguagesEdit->setEnabled(LocalOcr::isAvailable());
+    layout->addRow("OCR Languages:", ocrLanguagesEdit);
+
+    // Result cache
+    auto *cacheSizeSpin = new QSpinBox();
+    cacheSizeSpin->setRange(0, 512);
+    cacheSizeSpin->setSuffix(" MB");
+    cacheSizeSpin->setSpecialValueText("Off");
+    cacheSizeSpin->setValue(m_settings->resultCacheSizeMB());
+    layout->addRow("Result Cache:", cacheSizeSpin);
+
+    auto *diskCacheCheck = new QCheckBox("Keep cached results across restarts");
+    diskCacheCheck->setChecked(m_settings->diskCacheEnabled());
+    layout->addRow("Disk Cache:", diskCacheCheck);
+
+    auto *memorySizeSpin = new QSpinBox();
+    memorySizeSpin->setRange(0, 64);
+    memorySizeSpin->setSuffix(" MB");
+    memorySizeSpin->setSpecialValueText("Off");
+    memorySizeSpin->setToolTip("Lines translated before are filled in without asking the "
+                               "model (local OCR only)");
+    memorySizeSpin->setValue(m_settings->translationMemorySizeMB());
+    memorySizeSpin->setEnabled(LocalOcr::isAvailable());
+    layout->addRow("Translation Memory:", memorySizeSpin);
+
+    auto *nearMatchSpin = new QSpinBox();
+    nearMatchSpin->setRange(0, 64);
+    nearMatchSpin->setSuffix(" bits");
+    nearMatchSpin->setSpecialValueText("Exact only");
+    nearMatchSpin->setToolTip("How many of the 256 fingerprint bits may differ for a "
+                              "capture to reuse an earlier result");
+    nearMatchSpin->setValue(m_settings->nearMatchThreshold());
+    layout->addRow("Near-Duplicate Tolerance:", nearMatchSpin);
+
+    auto *transportCombo = new QComboBox();
+    transportCombo->addItem("libcurl", static_cast<int>(AIService::Transport::Curl));
+    transportCombo->addItem("Qt Network (HTTP/2)", static_cast<int>(AIService::Transport::QtNetwork));
+    transportCombo->setCurrentIndex(static_cast<int>(m_settings->transport()));
+    layout->addRow("HTTP Transport:", transportCombo);
+
+    auto *queueCheck = new QCheckBox("Finish earlier captures instead of cancelling them");
+    queueCheck->setChecked(m_settings->queueCaptures());
+    layout->addRow("Repeated Captures:", queueCheck);
+
+    auto *liveIntervalSpin = new QSpinBox();
+    liveIntervalSpin->setRange(250, 10000);
+    liveIntervalSpin->setSingleStep(250);
+    liveIntervalSpin->setSuffix(" ms");
+    liveIntervalSpin->setToolTip("How often a live region is checked for changed text");
+    liveIntervalSpin->setValue(m_settings->liveIntervalMs());
+    layout->addRow("Live Region Interval:", liveIntervalSpin);
+
+    auto *continueCheck = new QCheckBox("Request the missing remainder");
+    continueCheck->setToolTip("When a reply hits the output token limit, ask only for the "
+                              "blocks after the last complete one");
+    continueCheck->setChecked(m_settings->continueTruncated());
+    layout->addRow("Truncated Replies:", continueCheck);
+
     // OK / Cancel
     auto *buttons = new QDialogButtonBox(
         QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
@@ -224,11 +1181,40 @@ void TrayApp::showSettingsDialog() {
         m_settings->setBaseUrl(Settings::Backend::OpenAI, openaiUrlEdit->text());
         m_settings->setModelName(Settings::Backend::OpenAI, openaiModelEdit->text());
         m_settings->setApiKey(Settings::Backend::OpenAI, openaiKeyEdit->text());
+        m_settings->setStreamResponses(Settings::Backend::OpenAI, openaiStreamCheck->isChecked());
+        m_settings->setEncoderSettings(Settings::Backend::OpenAI,
+                                       encoderFrom(openaiFormatCombo, openaiQualitySpin));
         m_settings->setBaseUrl(Settings::Backend::Gemini, geminiUrlEdit->text());
         m_settings->setModelName(Settings::Backend::Gemini, geminiModelEdit->text());
         m_settings->setApiKey(Settings::Backend::Gemini, geminiKeyEdit->text());
+        m_settings->setStreamResponses(Settings::Backend::Gemini, geminiStreamCheck->isChecked());
+        m_settings->setEncoderSettings(Settings::Backend::Gemini,
+                                       encoderFrom(geminiFormatCombo, geminiQualitySpin));
+        m_settings->setHedgeRequests(hedgeCheck->isChecked());
+        m_settings->setHedgeBackend(
+            static_cast<Settings::Backend>(hedgeBackendCombo->currentData().toInt()));
+        m_settings->setHedgeModel(hedgeModelEdit->text());
+        m_settings->setHedgeDelayMs(hedgeDelaySpin->value());
         m_settings->setTargetLanguage(langCombo->currentText());
         m_settings->setOverlayFontSize(fontSizeSpin->value());
+        m_settings->setTargetTextHeight(textHeightSpin->value());
+        m_settings->setImageColorMode(
+            static_cast<PreprocessOptions::ColorMode>(colorModeCombo->currentData().toInt()));
+        m_settings->setTileLargeCaptures(tileCheck->isChecked());
+        if (LocalOcr::isAvailable()) {
+            m_settings->setLocalOcr(ocrCheck->isChecked());
+            m_settings->setOcrLanguages(ocrLanguagesEdit->text().trimmed());
+        }
+        m_settings->setResultCacheSizeMB(cacheSizeSpin->value());
+        m_settings->setDiskCacheEnabled(diskCacheCheck->isChecked());
+        m_settings->setTranslationMemorySizeMB(memorySizeSpin->value());
+        m_settings->setNearMatchThreshold(nearMatchSpin->value());
+        m_settings->setQueueCaptures(queueCheck->isChecked());
+        m_settings->setContinueTruncated(continueCheck->isChecked());
+        m_settings->setLiveIntervalMs(liveIntervalSpin->value());
+        m_liveRegion->setInterval(liveIntervalSpin->value());
+        m_settings->setTransport(
+            static_cast<AIService::Transport>(transportCombo->currentData().toInt()));
 
         // Re-register hotkey if changed
         QKeySequence newHotkey = hotkeyEdit->keySequence();
@@ -238,6 +1224,8 @@ void TrayApp::showSettingsDialog() {
         }
 
         m_overlayWindow->setFontSize(m_settings->overlayFontSize());
+        applyCacheSettings();
+        applySchedulerSettings();
         createAIService();
     }
 }
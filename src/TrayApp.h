@@ -3,6 +3,10 @@
 #include <QObject>
 #include <QSystemTrayIcon>
 #include <QMenu>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
 #include <QVector>
 
 #include "Settings.h"
@@ -10,6 +14,13 @@
 #include "RegionSelector.h"
 #include "OverlayWindow.h"
 #include "AIService.h"
+#include "TranslationCache.h"
+#include "TranslationMemory.h"
+#include "RequestStats.h"
+#include "TrafficArchive.h"
+#include "CapturePipeline.h"
+#include "LiveRegion.h"
+#include "RequestScheduler.h"
 
 class TrayApp : public QObject {
     Q_OBJECT
@@ -21,21 +32,116 @@ public:
 
 private slots:
     void onHotkeyTriggered();
-    void onRegionSelected(const QRect &region, const QPixmap &screenshot);
-    void onTranslationReady(const QVector<TextBlock> &blocks);
-    void onTranslationFailed(const QString &error);
+    void onRegionSelected(const QRect &region, const RegionGrab &grab);
+    void onCaptureComposed(const CapturePipeline::Handle &capture);
+    void onCaptureEncoded(const CapturePipeline::Handle &capture);
+    void onCaptureRecognized(const CapturePipeline::Handle &capture);
+    void onBlocksReceived(quint64 requestId, const QVector<TextBlock> &blocks);
+    void onTranslationReady(quint64 requestId, const QVector<TextBlock> &blocks);
+    void onTranslationTruncated(quint64 requestId);
+    void onTranslationTimedOut(quint64 requestId);
+    void onFirstByteTimed(quint64 requestId, double ms);
+    void onRequestSent(quint64 requestId, qint64 bytes);
+    void onTranslationFailed(quint64 requestId, const QString &error);
+    void onLiveRegionChanged(const QRect &area, const RegionGrab &grab);
     void showSettingsDialog();
+    void showStatsDialog();
+    void saveTrace();
 
 private:
     void createTrayIcon();
     void createAIService();
+    void encodeCapture(const CapturePipeline::Handle &capture);
+    AIService *createBackend(Settings::Backend backend, const QString &modelName);
+    void configureBackend(AIService *service, Settings::Backend backend);
+    void openTrafficArchive();
     void registerHotkey();
+    void applyCacheSettings();
+    void showCaptureResult(quint64 captureId, const QRect &region,
+                           const QVector<TextBlock> &blocks);
+    void dropPendingRequests();
+    void sendTiles(const CapturePipeline::Handle &capture,
+                   const RequestScheduler::Options &options);
+    void applySchedulerSettings();
+    CapturePipeline::CacheContext cacheContext() const;
+    RequestScheduler::Options requestOptions(quint64 captureId) const;
+    void startLive(const QRect &region);
+    void stopLive();
+    void finishLiveCapture(quint64 captureId, bool ok);
+    void updateLive(const QRect &area, const QVector<TextBlock> &blocks);
 
     Settings *m_settings = nullptr;
     HotkeyManager *m_hotkeyManager = nullptr;
     RegionSelector *m_regionSelector = nullptr;
     OverlayWindow *m_overlayWindow = nullptr;
     AIService *m_aiService = nullptr;
+    CapturePipeline *m_capturePipeline = nullptr;
+    LiveRegion *m_liveRegion = nullptr;
+    QAction *m_liveAction = nullptr;
+    bool m_pickingLive = false;           // the next selection pins a live region
+    QSet<quint64> m_liveCaptures;         // live updates in flight
+    QVector<TextBlock> m_liveBlocks;      // normalized to the live region
+    RequestScheduler *m_scheduler = nullptr;
+    Settings::Backend m_aiBackend = Settings::Backend::OpenAI;
+    bool m_hedged = false;
+    QStringList m_hedgeConfig; // what the hedged pair was built from
     QSystemTrayIcon *m_trayIcon = nullptr;
     QMenu *m_trayMenu = nullptr;
+
+    // Results of a capture sent as tiles, merged once every tile is back
+    struct TileGroup {
+        QVector<QRectF> areas;
+        QVector<QVector<TextBlock>> blocks; // mapped into the whole capture
+        int remaining = 0;
+        int failed = 0;
+        bool truncated = false;
+        QString error;
+    };
+
+    struct PendingRequest {
+        quint64 captureId = 0;
+        QRect region;
+        TranslationCache::Query cacheQuery;
+        bool truncated = false;
+        bool timedOut = false;
+        std::shared_ptr<TileGroup> tiles; // set for each tile of a tiled capture
+        int tile = 0;
+        const char *path = "vision";      // how the capture was sent, for the stats
+        QElapsedTimer clock;              // started when the selection was made
+        // Local OCR: every line, those found in the translation memory
+        // already translated, and which of them were sent
+        QVector<TextBlock> lines;
+        QVector<int> sentLines;
+        QString targetLanguage;
+        RequestStats::Context stats;      // which histograms it counts toward
+    };
+
+    void finishTile(const PendingRequest &pending);
+    void recordResult(const PendingRequest &pending);
+    RequestStats::Context statsContext(const char *path) const;
+    void updateTrayTooltip(const RequestStats::Context &context);
+    QVector<TextBlock> fillLines(const PendingRequest &pending, const QVector<TextBlock> &blocks);
+    QString memoryPath() const;
+    void saveTranslationMemory();
+
+    TranslationCache m_translationCache;
+    TranslationMemory m_translationMemory;
+    RequestStats m_requestStats;
+    std::shared_ptr<TrafficArchive::Recorder> m_trafficRecorder;
+    std::shared_ptr<TrafficArchive::Replay> m_trafficReplay;
+    QTimer *m_memorySaveTimer = nullptr;
+    QHash<quint64, PendingRequest> m_pendingRequests; // by request id
+    quint64 m_overlayCapture = 0; // capture whose region the overlay covers
+    quint64 m_shownCapture = 0;   // newest capture with a result on screen
+    qint64 m_hotkeyUs = -1;       // trace clock at the last hotkey press
+    quint64 m_tracedCapture = 0;  // capture that hotkey press led to
+
+    static constexpr qint64 DISK_CACHE_LIMIT = 64 * 1024 * 1024;
+    // Providers downscale anything larger before the model sees it
+    static constexpr int MAX_UPLOAD_EDGE = 2048;
+    // Small enough that providers look at tiles close to native resolution
+    static constexpr int TILE_EDGE = 1024;
+    static constexpr int DEFAULT_CONCURRENT_REQUESTS = 2;
+    // New memory entries are written out this long after the first of them
+    static constexpr int MEMORY_SAVE_DELAY_MS = 30000;
 };